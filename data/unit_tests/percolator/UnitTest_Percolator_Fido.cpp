@@ -26,6 +26,8 @@
 #include "Set.cpp"
 #include "Numerical.cpp"
 #include "Vector.cpp"
+#include "HashTable.h"
+#include "DisjointSet.h"
 #include "BaseSpline.h"
 
 class FidoVectorTest : public ::testing::Test {
@@ -198,3 +200,108 @@ EXPECT_EQ(-15,(int)res[0]);
 EXPECT_EQ(8,(int)res[1]);
 EXPECT_EQ(2,(int)res[2]);
 }
+
+unsigned int fidoIdentityHash(const int & key) {
+  return key;
+}
+
+unsigned int fidoConstantHash(const int &) {
+  return 7;
+}
+
+TEST(FidoHashTableTest, growsPastInitialSize){
+  HashTable<int> ht(fidoIdentityHash, 4);
+  for (int k = 0; k < 1000; k++) {
+    EXPECT_TRUE(ht.add(3 * k));
+  }
+  EXPECT_EQ(1000, ht.numElements());
+  for (int k = 0; k < 1000; k++) {
+    EXPECT_EQ(k, ht.lookup(3 * k));
+    EXPECT_EQ(3 * k, ht[k]);
+  }
+  EXPECT_EQ(-1, ht.lookup(1));
+}
+
+TEST(FidoHashTableTest, duplicateAdd){
+  HashTable<int> ht(fidoConstantHash);
+  EXPECT_TRUE(ht.add(5));
+  EXPECT_TRUE(ht.add(6));
+  EXPECT_FALSE(ht.add(5));
+  EXPECT_FALSE(ht.add(6));
+  EXPECT_EQ(2, ht.numElements());
+  EXPECT_EQ(0, ht.lookup(5));
+  EXPECT_EQ(1, ht.lookup(6));
+}
+
+TEST(FidoHashTableTest, insertReturnsExistingNumber){
+  HashTable<int> ht(fidoConstantHash, 2);
+  for (int k = 0; k < 100; k++) {
+    EXPECT_EQ(k, ht.insert(10 * k));
+  }
+  for (int k = 99; k >= 0; k--) {
+    EXPECT_EQ(k, ht.insert(10 * k));
+  }
+  EXPECT_EQ(100, ht.numElements());
+  EXPECT_EQ(420, ht.getItem(42));
+}
+
+TEST(FidoSetTest, insertAndEraseKeepSortedAndUnique){
+  Set s;
+  int values[] = { 5, 1, 9, 5, 3, 1, 7, 9 };
+  for (int k = 0; k < 8; k++) {
+    s.insert(values[k]);
+  }
+  int expected[] = { 1, 3, 5, 7, 9 };
+  ASSERT_EQ(5, s.size());
+  for (int k = 0; k < 5; k++) {
+    EXPECT_EQ(expected[k], s[k]);
+  }
+  s.erase(4); // not in the set
+  EXPECT_EQ(5, s.size());
+  s.erase(1);
+  s.erase(9);
+  s.erase(9);
+  ASSERT_EQ(3, s.size());
+  EXPECT_EQ(3, s[0]);
+  EXPECT_EQ(5, s[1]);
+  EXPECT_EQ(7, s[2]);
+  s.insert(4);
+  EXPECT_EQ(1, s.find(4));
+  s.erase(3);
+  s.erase(4);
+  s.erase(5);
+  s.erase(7);
+  EXPECT_TRUE(s.isEmpty());
+}
+
+TEST(FidoSetTest, reindexBy){
+  Set s;
+  s.insert(1);
+  s.insert(3);
+  Array<int> newIndex(4, -1);
+  newIndex[1] = 0;
+  newIndex[3] = 1;
+  Set c = s.reindexBy(newIndex);
+  ASSERT_EQ(2, c.size());
+  EXPECT_EQ(0, c[0]);
+  EXPECT_EQ(1, c[1]);
+  s.insert(2);
+  EXPECT_THROW(s.reindexBy(newIndex), Set::InvalidBaseException);
+}
+
+TEST(FidoDisjointSetTest, labelBySmallestElement){
+  DisjointSet ds(7);
+  ds.unite(5, 3);
+  ds.unite(4, 1);
+  ds.unite(2, 5);
+  ds.unite(6, 4);
+  std::vector<int> componentOf;
+  EXPECT_EQ(3, ds.label(componentOf));
+  int expected[] = { 0, 1, 2, 2, 1, 2, 1 };
+  ASSERT_EQ(7u, componentOf.size());
+  for (int k = 0; k < 7; k++) {
+    EXPECT_EQ(expected[k], componentOf[k]);
+  }
+  EXPECT_EQ(ds.find(2), ds.find(3));
+  EXPECT_NE(ds.find(0), ds.find(1));
+}
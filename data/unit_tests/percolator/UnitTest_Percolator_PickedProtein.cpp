@@ -0,0 +1,256 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+/* This file include test cases for the picked protein indices */
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "PeptideProteinIndex.cpp"
+#include "GeneralizedSuffixArray.cpp"
+#include "StringInterner.h"
+
+typedef PeptideProteinIndex::Entry PeptideEntry;
+
+static std::vector<size_t> pickedProteinsOf(const PeptideProteinIndex& index,
+                                            const std::string& peptide) {
+  std::pair<PeptideProteinIndex::ProteinIterator,
+            PeptideProteinIndex::ProteinIterator> range =
+      index.getProteins(peptide.data(), peptide.size());
+  return std::vector<size_t>(range.first, range.second);
+}
+
+// builds an index over numEntries occurrences of numPeptides peptides,
+// spread over the proteins in a scrambled order, and checks every peptide
+static void checkPeptideProteinIndex(size_t numEntries, size_t numPeptides) {
+  std::vector<std::string> peptides(numPeptides);
+  for (size_t k = 0; k < numPeptides; ++k) {
+    std::ostringstream peptide;
+    peptide << "PEP" << k << "TIDE";
+    peptides[k] = peptide.str();
+  }
+  std::vector<std::vector<PeptideEntry> > entries(3);
+  std::vector<std::vector<size_t> > expected(numPeptides);
+  for (size_t k = 0; k < numEntries; ++k) {
+    size_t peptideIdx = (k * 7) % numPeptides;
+    size_t proteinIdx = (k * 13) % 101;
+    const std::string& peptide = peptides[peptideIdx];
+    entries[k % 3].push_back(PeptideProteinIndex::makeEntry(
+        peptide.data(), peptide.size(), proteinIdx));
+  }
+  // the proteins of a peptide keep the order of the ranges and, within a
+  // range, the order of emission
+  for (size_t range = 0; range < 3; ++range) {
+    for (size_t k = 0; k < entries[range].size(); ++k) {
+      const PeptideEntry& entry = entries[range][k];
+      size_t peptideIdx = 0;
+      while (peptides[peptideIdx].data() != entry.sequence) ++peptideIdx;
+      expected[peptideIdx].push_back(entry.protein_idx);
+    }
+  }
+
+  PeptideProteinIndex index;
+  index.build(entries);
+  EXPECT_EQ(numPeptides, index.getNumPeptides());
+  for (size_t k = 0; k < 3; ++k) {
+    EXPECT_TRUE(entries[k].empty());
+  }
+  for (size_t k = 0; k < numPeptides; ++k) {
+    EXPECT_EQ(expected[k], pickedProteinsOf(index, peptides[k]));
+  }
+  EXPECT_TRUE(pickedProteinsOf(index, "NOTINDEXED").empty());
+}
+
+TEST(PeptideProteinIndexTest, comparisonSortBelowRadixThreshold){
+  checkPeptideProteinIndex(kMinRadixSortSize - 1, 50);
+}
+
+TEST(PeptideProteinIndexTest, radixSortAboveThreshold){
+  checkPeptideProteinIndex(5 * kMinRadixSortSize + 3, 500);
+}
+
+TEST(PeptideProteinIndexTest, proteinOrderWithinPeptide){
+  std::string protein = "KPEPTIDERPEPTIDEK";
+  const char* peptide = protein.data() + 1;
+  std::vector<std::vector<PeptideEntry> > entries(2);
+  entries[0].push_back(PeptideProteinIndex::makeEntry(peptide, 7, 5));
+  entries[0].push_back(PeptideProteinIndex::makeEntry(protein.data(), 1, 5));
+  entries[0].push_back(PeptideProteinIndex::makeEntry(peptide + 8, 7, 2));
+  entries[1].push_back(PeptideProteinIndex::makeEntry(peptide, 7, 9));
+  entries[1].push_back(PeptideProteinIndex::makeEntry(peptide + 8, 7, 1));
+  PeptideProteinIndex index;
+  index.build(entries);
+  EXPECT_EQ(2u, index.getNumPeptides());
+  size_t expected[] = { 5, 2, 9, 1 };
+  EXPECT_EQ(std::vector<size_t>(expected, expected + 4),
+            pickedProteinsOf(index, "PEPTIDE"));
+  EXPECT_EQ(std::vector<size_t>(1, 5), pickedProteinsOf(index, "K"));
+}
+
+TEST(PeptideProteinIndexTest, hashCollision){
+  // give the entries of AAAK the hash of CCCK, such that both peptides end
+  // up in the same run of hashes and have to be told apart by sequence
+  std::string first = "AAAK", second = "CCCK";
+  uint64_t hash = PeptideProteinIndex::hashSequence(second.data(), 4);
+  std::vector<std::vector<PeptideEntry> > entries(1);
+  int proteins[] = { 3, 1, 4, 1, 5, 9 };
+  for (int k = 0; k < 6; ++k) {
+    const std::string& peptide = (k % 2 == 0) ? second : first;
+    entries[0].push_back(PeptideProteinIndex::makeEntry(peptide.data(), 4,
+                                                        proteins[k]));
+    entries[0].back().hash = hash;
+  }
+  PeptideProteinIndex index;
+  index.build(entries);
+  EXPECT_EQ(2u, index.getNumPeptides());
+  // AAAK sorts first in the run, so the lookup has to skip it
+  size_t expected[] = { 3, 4, 5 };
+  EXPECT_EQ(std::vector<size_t>(expected, expected + 3),
+            pickedProteinsOf(index, second));
+  // the lookup of AAAK itself uses its true hash, which is not indexed
+  EXPECT_TRUE(pickedProteinsOf(index, first).empty());
+}
+
+static std::vector<size_t> superstringsOf(const GeneralizedSuffixArray& gsa,
+                                          size_t seqIdx) {
+  std::vector<size_t> seqIdxs;
+  gsa.findSuperstrings(seqIdx, seqIdxs);
+  return seqIdxs;
+}
+
+static void addSequences(GeneralizedSuffixArray& gsa,
+                         const std::vector<std::string>& sequences) {
+  for (size_t k = 0; k < sequences.size(); ++k) {
+    gsa.addSequence(sequences[k].data(), sequences[k].size());
+  }
+  gsa.build();
+}
+
+TEST(GeneralizedSuffixArrayTest, emptySequence){
+  std::vector<std::string> sequences;
+  sequences.push_back("PEPTIDE");
+  sequences.push_back("");
+  sequences.push_back("PEP");
+  GeneralizedSuffixArray gsa;
+  addSequences(gsa, sequences);
+  EXPECT_EQ(3u, gsa.getNumSequences());
+  size_t all[] = { 0, 1, 2 };
+  EXPECT_EQ(std::vector<size_t>(all, all + 3), superstringsOf(gsa, 1));
+  size_t pep[] = { 0, 2 };
+  EXPECT_EQ(std::vector<size_t>(pep, pep + 2), superstringsOf(gsa, 2));
+  EXPECT_EQ(std::vector<size_t>(1, 0), superstringsOf(gsa, 0));
+}
+
+TEST(GeneralizedSuffixArrayTest, identicalSequences){
+  std::vector<std::string> sequences;
+  sequences.push_back("ELVISK");
+  sequences.push_back("LVIS");
+  sequences.push_back("ELVISK");
+  GeneralizedSuffixArray gsa;
+  addSequences(gsa, sequences);
+  size_t same[] = { 0, 2 };
+  EXPECT_EQ(std::vector<size_t>(same, same + 2), superstringsOf(gsa, 0));
+  EXPECT_EQ(std::vector<size_t>(same, same + 2), superstringsOf(gsa, 2));
+  size_t all[] = { 0, 1, 2 };
+  EXPECT_EQ(std::vector<size_t>(all, all + 3), superstringsOf(gsa, 1));
+}
+
+TEST(GeneralizedSuffixArrayTest, notAcrossSeparator){
+  std::vector<std::string> sequences;
+  sequences.push_back("XA");
+  sequences.push_back("BY");
+  sequences.push_back("AB");
+  sequences.push_back("XAB");
+  GeneralizedSuffixArray gsa;
+  addSequences(gsa, sequences);
+  size_t ab[] = { 2, 3 };
+  EXPECT_EQ(std::vector<size_t>(ab, ab + 2), superstringsOf(gsa, 2));
+  size_t xa[] = { 0, 3 };
+  EXPECT_EQ(std::vector<size_t>(xa, xa + 2), superstringsOf(gsa, 0));
+  EXPECT_EQ(std::vector<size_t>(1, 1), superstringsOf(gsa, 1));
+}
+
+TEST(GeneralizedSuffixArrayTest, matchesNaiveSearch){
+  std::vector<std::string> sequences;
+  unsigned int state = 12345u;
+  for (int k = 0; k < 60; ++k) {
+    state = state * 1103515245u + 12345u;
+    std::string sequence;
+    for (unsigned int length = (state >> 16) % 7; length > 0; --length) {
+      state = state * 1103515245u + 12345u;
+      sequence.push_back(((state >> 16) % 3 == 0) ? 'B' : 'A');
+    }
+    sequences.push_back(sequence);
+  }
+  GeneralizedSuffixArray gsa;
+  addSequences(gsa, sequences);
+  for (size_t i = 0; i < sequences.size(); ++i) {
+    std::vector<size_t> expected;
+    for (size_t j = 0; j < sequences.size(); ++j) {
+      if (sequences[j].find(sequences[i]) != std::string::npos) {
+        expected.push_back(j);
+      }
+    }
+    EXPECT_EQ(expected, superstringsOf(gsa, i)) << "sequence " << i;
+  }
+}
+
+TEST(StringInternerTest, rehashKeepsIds){
+  StringInterner ids;
+  std::vector<std::string> proteins;
+  for (int k = 0; k < 2000; ++k) {
+    std::ostringstream protein;
+    protein << "sp|P" << k << "|PROT_YEAST";
+    proteins.push_back(protein.str());
+    EXPECT_EQ(static_cast<unsigned int>(k), ids.intern(proteins.back()));
+  }
+  EXPECT_EQ(2000u, ids.size());
+  for (int k = 0; k < 2000; ++k) {
+    EXPECT_EQ(k, ids.find(proteins[k]));
+    EXPECT_EQ(static_cast<unsigned int>(k), ids.intern(proteins[k]));
+    EXPECT_EQ(proteins[k], ids.getString(k));
+  }
+  EXPECT_EQ(2000u, ids.size());
+  EXPECT_EQ(StringInterner::kNotFound, ids.find("sp|P2000|PROT_YEAST"));
+  
+  const std::string& first = ids.getString(0);
+  ids.reserve(10000);
+  EXPECT_EQ(&first, &ids.getString(0));
+  EXPECT_EQ(1999, ids.find(proteins[1999]));
+  
+  ids.clear();
+  EXPECT_EQ(0u, ids.size());
+  EXPECT_EQ(StringInterner::kNotFound, ids.find(proteins[0]));
+  EXPECT_EQ(0u, ids.intern(proteins[1]));
+}
+
+TEST(StringInternerTest, findSubstring){
+  StringInterner ids;
+  EXPECT_EQ(StringInterner::kNotFound, ids.find("PROT", 4));
+  ids.intern("PROT_1");
+  ids.intern("");
+  const char line[] = "PROT_12\tdecoy_PROT_1";
+  EXPECT_EQ(0, ids.find(line, 6));
+  EXPECT_EQ(StringInterner::kNotFound, ids.find(line, 7));
+  EXPECT_EQ(StringInterner::kNotFound, ids.find(line, 5));
+  EXPECT_EQ(0, ids.find(line + 14, 6));
+  EXPECT_EQ(1, ids.find(line, 0));
+  EXPECT_EQ(2u, ids.intern(line + 8, 12));
+  EXPECT_EQ("decoy_PROT_1", ids.getString(2));
+  EXPECT_EQ(0u, ids.intern(line + 14, 6));
+}
@@ -24,6 +24,7 @@
  */
 
 #include "UnitTest_Percolator_Fido.cpp"
+#include "UnitTest_Percolator_PickedProtein.cpp"
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
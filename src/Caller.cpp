@@ -39,7 +39,7 @@ Caller::Caller() :
     numIterations_(10), maxPSMs_(0u),
     nestedXvalBins_(1u), selectedCpos_(0.0), selectedCneg_(0.0),
     reportEachIteration_(false), quickValidation_(false), 
-    trainBestPositive_(false) {
+    trainBestPositive_(false), singlePassNormalization_(false) {
 }
 
 Caller::~Caller() {
@@ -364,6 +364,20 @@ bool Caller::parseOptions(int argc, char **argv) {
       "parameter-file",
       "Read flags from a parameter file. If flags are specified on the command line as well, these will override the ones in the parameter file.",
       "filename");
+  cmd.defineOption(Option::EXPERIMENTAL_FEATURE,
+      "single-pass-normalization",
+      "Collect the feature normalization statistics while reading the tab-delimited input, instead of in separate passes over all PSMs afterwards. Has no effect in combination with -N/--subset-max-train.",
+      "",
+      TRUE_IF_SET);
+  cmd.defineOption(Option::EXPERIMENTAL_FEATURE,
+      "picked-protein-cache",
+      "Only available if -f is set to a fasta file. Store the protein fragments and duplicates detected in the fasta database in a file next to it, named after the fasta file with the extension .digest-cache, and reuse them in later runs with the same fasta file and digestion parameters.",
+      "",
+      TRUE_IF_SET);
+  cmd.defineOption(Option::EXPERIMENTAL_FEATURE,
+      "doc-max-train",
+      "Only available if -D is set. Maximum number of unique peptides, stratified by retention time, to train the retention time model on in each iteration. Default = 0, which trains on all confident peptides.",
+      "value");
   
   /*
   cmd.defineOption(Option::NO_SHORT_OPT,
@@ -534,13 +548,14 @@ bool Caller::parseOptions(int argc, char **argv) {
       //if (cmd.optionSet("Q")) pickedProteinPvalueCutoff = cmd.getDouble("Q", 0.0, 1.0);
       if (cmd.optionSet("protein-report-fragments")) pickedProteinReportFragmentProteins = true;
       if (cmd.optionSet("protein-report-duplicates")) pickedProteinReportDuplicateProteins = true;
+      bool pickedProteinUseDigestCache = cmd.optionSet("picked-protein-cache");
       
       protEstimator_ = new PickedProteinInterface(fastaDatabase,
           pickedProteinPvalueCutoff, pickedProteinReportFragmentProteins, 
           pickedProteinReportDuplicateProteins,
           protEstimatorTrivialGrouping, protEstimatorAbsenceRatio, 
           protEstimatorOutputEmpirQVal, protEstimatorDecoyPrefix,
-          protEstimatorPeptideQvalThreshold);
+          protEstimatorPeptideQvalThreshold, pickedProteinUseDigestCache);
     }
   }
   
@@ -606,6 +621,9 @@ bool Caller::parseOptions(int argc, char **argv) {
   if (cmd.optionSet("train-best-positive")) {
     trainBestPositive_ = true;
   }
+  if (cmd.optionSet("single-pass-normalization")) {
+    singlePassNormalization_ = true;
+  }
   if (cmd.optionSet("trainFDR")) {
     selectionFdr_ = cmd.getDouble("trainFDR", 0.0, 1.0);
     initialSelectionFdr_ = selectionFdr_;
@@ -632,6 +650,10 @@ bool Caller::parseOptions(int argc, char **argv) {
   if (cmd.optionSet("klammer")) {
     DescriptionOfCorrect::setKlammer(true);
   }
+  if (cmd.optionSet("doc-max-train")) {
+    DescriptionOfCorrect::setMaxTrainPeptides(
+        cmd.getInt("doc-max-train", 0, 100000000));
+  }
   if (cmd.optionSet("no-schema-validation")) {
     xmlSchemaValidation_ = false;
   }
@@ -915,6 +937,7 @@ int Caller::run() {
   XMLInterface xmlInterface(xmlOutputFN_, xmlSchemaValidation_, 
                             xmlPrintDecoys_, xmlPrintExpMass_);
   SetHandler setHandler(maxPSMs_);
+  setHandler.setCollectFeatureStatistics(singlePassNormalization_);
   if (!tabInput_) {
     if (VERB > 1) {
       std::cerr << "Reading pin-xml input from datafile " << inputFN_ << std::endl;
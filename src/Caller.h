@@ -99,6 +99,9 @@ class Caller {
   bool reportEachIteration_, quickValidation_, trainBestPositive_,
     skipNormalizeScores_;
   
+  // input processing parameters
+  bool singlePassNormalization_;
+  
   // reporting parameters
   std::string call_;
   
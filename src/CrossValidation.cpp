@@ -144,6 +144,13 @@ void CrossValidation::train(Normalizer* pNorm) {
     cerr << ", fdr=" << selectionFdr_ << endl;
   }
   
+  featureZeros_.assign(FeatureNames::getNumFeatures(), 0.0);
+  if (pNorm) {
+    for (size_t ix = 0; ix < featureZeros_.size(); ++ix) {
+      featureZeros_[ix] = pNorm->normalize(0.0, ix);
+    }
+  }
+  
   // iterate
   int foundPositivesOldOld = 0, foundPositivesOld = 0, foundPositives = 0; 
   for (unsigned int i = 0; i < niter_; i++) {
@@ -342,6 +349,7 @@ int CrossValidation::processSingleFold(unsigned int set, double selectionFdr,
   for (unsigned int nestedFold = 0; nestedFold < nestedXvalBins_; ++nestedFold) {
     nestedTrainScores[nestedFold].generateNegativeTrainingSet(*svmInput, 1.0);
     nestedTrainScores[nestedFold].generatePositiveTrainingSet(*svmInput, selectionFdr, 1.0, trainBestPositive_);
+    svmInput->buildSparse(featureZeros_);
     
     if (VERB > 2) {
       cerr << "Split " << set + 1 << ": Training with " 
@@ -426,6 +434,7 @@ int CrossValidation::processSingleFold(unsigned int set, double selectionFdr,
     }    
     trainScores_[set].generateNegativeTrainingSet(*svmInput, 1.0);
     trainScores_[set].generatePositiveTrainingSet(*svmInput, selectionFdr, 1.0, trainBestPositive_);
+    svmInput->buildSparse(featureZeros_);
     
     // Create storage vector for SVM algorithm
     struct vector_double* Outputs = new vector_double;
@@ -93,6 +93,9 @@ class CrossValidation {
   const static unsigned int numAlgInObjects_;
   std::vector<Scores> trainScores_, testScores_;
   std::vector<double> candidatesCpos_, candidatesCfrac_;
+  // normalized value of a raw zero for each feature, left out of the 
+  // sparse SVM input
+  std::vector<double> featureZeros_;
   
   int processSingleFold(unsigned int set, double selectionFdr,
                          const vector<double>& cpos_vec, 
@@ -32,6 +32,8 @@ DataSet::DataSet() {}
 DataSet::~DataSet() {
   std::vector<PSMDescription*>::iterator it = psms_.begin();
   for ( ; it != psms_.end(); ++it) {
+    // the retention features are owned by the DescriptionOfCorrect cache
+    (*it)->setRetentionFeatures(NULL);
     PSMDescription::deletePtr(*it);
   }
 }
@@ -48,7 +50,7 @@ bool DataSet::writeTabData(ofstream& out) {
   std::vector<PSMDescription*>::iterator it = psms_.begin();
   for ( ; it != psms_.end(); ++it) {
     PSMDescription* psm = *it;
-    double* featureRow = psm->features;
+    FeatureValue* featureRow = psm->features;
     out << psm->getId() << '\t' << label_ << '\t' << psm->scan << '\t' 
         << psm->expMass << '\t' << psm->calcMass;
     if (calcDOC_) {
@@ -93,7 +95,7 @@ void DataSet::fillFeatures(std::vector<ScoreHolder>& scores) {
   }
 }
 
-void DataSet::fillFeatures(std::vector<double*>& features) {
+void DataSet::fillFeatures(std::vector<FeatureValue*>& features) {
   std::vector<PSMDescription*>::iterator it = psms_.begin();
   for ( ; it != psms_.end(); ++it) {
     PSMDescription* psm = *it;
@@ -101,7 +103,7 @@ void DataSet::fillFeatures(std::vector<double*>& features) {
   }
 }
 
-void DataSet::fillDOCFeatures(std::vector<double*>& features) {
+void DataSet::fillDOCFeatures(std::vector<FeatureValue*>& features) {
   std::vector<PSMDescription*>::iterator it = psms_.begin();
   for ( ; it != psms_.end(); ++it) {
     PSMDescription* psm = *it;
@@ -124,13 +126,23 @@ void DataSet::fillRtFeatures(std::vector<double*>& rtFeatures) {
  * @param dataStream filestream of tab delimited file, only passed to close on exception
  * TODO: remove dataStream parameter and return int with type of error to handle upstream.
  * @param line tab delimited string containing the psm details
+ * @param featureStats if not NULL, the feature row is added to these statistics
+ * @param rtFeatureStats if not NULL, the retention features are added to these statistics
  */
 void DataSet::readPsm(const std::string& line, const unsigned int lineNr,
-    const std::vector<OptionalField>& optionalFields, FeatureMemoryPool& featurePool) { 
+    const std::vector<OptionalField>& optionalFields, FeatureMemoryPool& featurePool,
+    FeatureStatistics* featureStats, FeatureStatistics* rtFeatureStats) { 
   PSMDescription* myPsm = NULL;
   bool readProteins = true;
   readPsm(line, lineNr, optionalFields, readProteins, myPsm, featurePool);
   registerPsm(myPsm);
+  // the row is still in cache, update the normalization statistics right away
+  if (featureStats) {
+    featureStats->add(myPsm->features);
+  }
+  if (rtFeatureStats && myPsm->getRetentionFeatures()) {
+    rtFeatureStats->add(myPsm->getRetentionFeatures());
+  }
 }
 
 int DataSet::readPsm(const std::string& line, const unsigned int lineNr,
@@ -188,7 +200,7 @@ int DataSet::readPsm(const std::string& line, const unsigned int lineNr,
   if (calcDOC_) {
     numFeatures -= DescriptionOfCorrect::numDOCFeatures();
   }
-  double* featureRow = featurePool.allocate();
+  FeatureValue* featureRow = featurePool.allocate();
   myPsm->features = featureRow;
   for (register unsigned int j = 0; j < numFeatures; j++) {
     featureRow[j] = reader.readDouble();
@@ -238,10 +250,10 @@ int DataSet::readPsm(const std::string& line, const unsigned int lineNr,
   }
   
   if (readProteins) {
-    std::vector<std::string> proteins;
+    std::vector<unsigned int> proteins;
     while (!reader.error()) {
       std::string tmp = reader.readString();
-      if (tmp.size() > 0) proteins.push_back(tmp);
+      if (tmp.size() > 0) proteins.push_back(PSMDescription::internProteinId(tmp));
     }
     proteins.swap(myPsm->proteinIds); // shrink to fit
   }
@@ -258,8 +270,7 @@ void DataSet::registerPsm(PSMDescription* myPsm) {
   }
   
   if (calcDOC_) {
-    myPsm->setRetentionFeatures(new double[RTModel::totalNumRTFeatures()]());
-    DescriptionOfCorrect::calcRegressionFeature(myPsm);
+    DescriptionOfCorrect::setCachedRegressionFeature(myPsm);
   }
   psms_.push_back(myPsm);
 }
@@ -36,6 +36,7 @@
 #include "FeatureNames.h"
 #include "DescriptionOfCorrect.h"
 #include "FeatureMemoryPool.h"
+#include "FeatureStatistics.h"
 #include "ProteinProbEstimator.h"
 
 // using char pointers is much faster than istringstream
@@ -144,13 +145,15 @@ class DataSet {
   void print_features();
 
   void fillFeatures(std::vector<ScoreHolder>& scores);
-  void fillFeatures(std::vector<double*>& features);
-  void fillDOCFeatures(std::vector<double*>& features);
+  void fillFeatures(std::vector<FeatureValue*>& features);
+  void fillDOCFeatures(std::vector<FeatureValue*>& features);
   void fillRtFeatures(std::vector<double*>& rtFeatures);
   
   void readPsm(const std::string& line, const unsigned int lineNr,
                const std::vector<OptionalField>& optionalFields, 
-               FeatureMemoryPool& featurePool);
+               FeatureMemoryPool& featurePool, 
+               FeatureStatistics* featureStats = NULL,
+               FeatureStatistics* rtFeatureStats = NULL);
   static int readPsm(const std::string& line, const unsigned int lineNr,
     const std::vector<OptionalField>& optionalFields, bool readProteins,
     PSMDescription*& myPsm, FeatureMemoryPool& featurePool);
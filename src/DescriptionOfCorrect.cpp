@@ -29,10 +29,12 @@
 
 string DescriptionOfCorrect::isoAlphabet = "DECYHKR";
 unsigned int DescriptionOfCorrect::docFeatures = 15;
+unsigned int DescriptionOfCorrect::maxTrainPeptides = 0;
 float DescriptionOfCorrect::pKiso[7] = { -3.86f, -4.25f, -8.33f, -10.0f, 6.0f,
                                          10.5f, 12.4f }; // Lehninger
 float DescriptionOfCorrect::pKN = 9.69f;
 float DescriptionOfCorrect::pKC = 2.34f;
+RetentionFeatureCache DescriptionOfCorrect::rtFeatureCache_;
 
 DescriptionOfCorrect::DescriptionOfCorrect() {
 }
@@ -50,6 +52,19 @@ void DescriptionOfCorrect::calcRegressionFeature(PSMDescription* psm) {
   //cout <<  peptide << " " << pep << " " << psm->getRetentionFeatures()[0] << endl;
 }
 
+void DescriptionOfCorrect::setCachedRegressionFeature(PSMDescription* psm) {
+  string pep = PSMDescription::removePTMs(psm->getFullPeptide());
+  bool isNew = false;
+  RetentionFeatureCache::Entry& entry = rtFeatureCache_.getEntry(pep, 
+      RTModel::totalNumRTFeatures(), isNew);
+  if (isNew) {
+    entry.isoElectricPoint = isoElectricPoint(pep);
+    RTModel::fillFeaturesAllIndex(pep, entry.features);
+  }
+  psm->setIsoElectricPoint(entry.isoElectricPoint);
+  psm->setRetentionFeatures(entry.features);
+}
+
 void DescriptionOfCorrect::trainCorrect() {
   // Get rid of redundant peptides
   sort(psms.begin(), psms.end(), PSMDescription::ptrLess);
@@ -68,16 +83,50 @@ void DescriptionOfCorrect::trainCorrect() {
     avgPI = piSum / psms.size();
     avgDM = dMSum / psms.size();
   }
-  rtModel.trainRetention(psms);
+  if (maxTrainPeptides > 0 && psms.size() > maxTrainPeptides) {
+    std::vector<PSMDescription*> trainset;
+    selectRetentionTrainingSet(trainset);
+    rtModel.trainRetention(trainset);
+  } else {
+    rtModel.trainRetention(psms);
+  }
   if (VERB > 2) {
     cerr << "Description of correct recalibrated, avg pI=" << avgPI
         << " avg dM=" << avgDM << endl;
   }
 }
 
+/**
+ * Picks maxTrainPeptides of the unique peptides, evenly spread over the
+ * retention time quantiles, as the training set of the retention time SVR.
+ * The SVR training scales worse than quadratically with the number of
+ * peptides, while a few thousand peptides over the whole gradient already
+ * give an accurate model.
+ */
+void DescriptionOfCorrect::selectRetentionTrainingSet(
+    std::vector<PSMDescription*>& trainset) {
+  std::vector<PSMDescription*> rtOrdered(psms);
+  stable_sort(rtOrdered.begin(), rtOrdered.end(), rtLess);
+  trainset.reserve(maxTrainPeptides);
+  double stride = rtOrdered.size() / (double)maxTrainPeptides;
+  for (unsigned int ix = 0; ix < maxTrainPeptides; ++ix) {
+    // take the middle peptide of each stratum
+    size_t pos = static_cast<size_t>((ix + 0.5) * stride);
+    trainset.push_back(rtOrdered[pos]);
+  }
+  if (VERB > 2) {
+    cerr << "Training retention time model on " << trainset.size() 
+        << " of " << psms.size() << " peptides" << endl;
+  }
+}
+
 void DescriptionOfCorrect::setFeatures(PSMDescription* psm) {
-  assert(DataSet::getFeatureNames().getDocFeatNum() > 0);
   psm->setPredictedRetentionTime(rtModel.estimateRT(psm->getRetentionFeatures()));
+  setFeaturesFromPrediction(psm);
+}
+
+void DescriptionOfCorrect::setFeaturesFromPrediction(PSMDescription* psm) {
+  assert(DataSet::getFeatureNames().getDocFeatNum() > 0);
   size_t docFeatNum = DataSet::getFeatureNames().getDocFeatNum();
   double dm = abs(psm->getMassDiff() - avgDM);
   double drt = abs(psm->getRetentionTime() - psm->getPredictedRetentionTime());
@@ -96,8 +145,31 @@ void DescriptionOfCorrect::setFeatures(PSMDescription* psm) {
   }
 }
 
+/**
+ * Sets the normalized DOC features of all psms, predicting their retention
+ * times in one batch
+ */
+void DescriptionOfCorrect::setFeaturesNormalized(std::vector<PSMDescription*>& psms, 
+                                                 Normalizer* pNorm) {
+  std::vector<double*> rtFeatures(psms.size());
+  for (size_t ix = 0; ix < psms.size(); ++ix) {
+    rtFeatures[ix] = psms[ix]->getRetentionFeatures();
+  }
+  std::vector<double> predictedRTs;
+  rtModel.estimateRTs(rtFeatures, predictedRTs);
+  for (size_t ix = 0; ix < psms.size(); ++ix) {
+    psms[ix]->setPredictedRetentionTime(predictedRTs[ix]);
+    setFeaturesFromPrediction(psms[ix]);
+    normalizeFeatures(psms[ix], pNorm);
+  }
+}
+
 void DescriptionOfCorrect::setFeaturesNormalized(PSMDescription* psm, Normalizer* pNorm) {
   setFeatures(psm);
+  normalizeFeatures(psm, pNorm);
+}
+
+void DescriptionOfCorrect::normalizeFeatures(PSMDescription* psm, Normalizer* pNorm) {
   size_t docFeatNum = DataSet::getFeatureNames().getDocFeatNum();
   if (docFeatures & 1) {
     psm->features[docFeatNum] = pNorm->normalize(psm->features[docFeatNum], docFeatNum);
@@ -21,6 +21,7 @@
 #include <vector>
 using namespace std;
 #include "EludeModel.h"
+#include "RetentionFeatureCache.h"
 
 
 class DescriptionOfCorrect {
@@ -34,6 +35,12 @@ class DescriptionOfCorrect {
       return avgPI;
     }
     static void calcRegressionFeature(PSMDescription* psm);
+    // as calcRegressionFeature, but the PSM gets the shared retention 
+    // features of its peptide from rtFeatureCache_
+    static void setCachedRegressionFeature(PSMDescription* psm);
+    static RetentionFeatureCache& getRetentionFeatureCache() {
+      return rtFeatureCache_;
+    }
     static double isoElectricPoint(const string& peptide);
     static void setKlammer(bool on) {
       RTModel::setDoKlammer(on);
@@ -41,6 +48,11 @@ class DescriptionOfCorrect {
     static void setDocType(const unsigned int dt) {
       docFeatures = dt;
     }
+    // maximum number of peptides to train the retention time model on,
+    // 0 means no limit
+    static void setMaxTrainPeptides(const unsigned int maxPeptides) {
+      maxTrainPeptides = maxPeptides;
+    }
     void clear() {
       psms.clear();
     }
@@ -50,6 +62,8 @@ class DescriptionOfCorrect {
     void trainCorrect();
     void setFeatures(PSMDescription* psm);
     void setFeaturesNormalized(PSMDescription* psm, Normalizer* pNorm);
+    void setFeaturesNormalized(std::vector<PSMDescription*>& psms, 
+                               Normalizer* pNorm);
     //static size_t totalNumRTFeatures() {return (doKlammer?64:minimumNumRTFeatures() + 20);}
     //static size_t minimumNumRTFeatures() {return 3*10+1+3;}
     void print_10features();
@@ -74,6 +88,7 @@ class DescriptionOfCorrect {
     }
 
   protected:
+    static RetentionFeatureCache rtFeatureCache_;
     double avgPI, avgDM;
     std::vector<PSMDescription*> psms;
     //  vector<double> rtW;
@@ -83,6 +98,15 @@ class DescriptionOfCorrect {
     static float pKiso[7];
     static float pKN, pKC;
     static unsigned int docFeatures;
+    static unsigned int maxTrainPeptides;
+    
+    static bool rtLess(PSMDescription* one, PSMDescription* other) {
+      return one->getRetentionTime() < other->getRetentionTime();
+    }
+    void selectRetentionTrainingSet(std::vector<PSMDescription*>& trainset);
+    // sets the DOC features from the already predicted retention time
+    void setFeaturesFromPrediction(PSMDescription* psm);
+    void normalizeFeatures(PSMDescription* psm, Normalizer* pNorm);
 };
 
 #endif /*DESCRIPTIONOFCORRECT_H_*/
@@ -1145,10 +1145,14 @@ void RTModel::trainSVM(vector<PSMDescription*> & psms) {
 // test the svm on the given test set
 double RTModel::testRetention(vector<PSMDescription*>& testset) {
   double rms = 0.0;
-  double estimatedRT;
+  vector<double*> features(testset.size());
   for (size_t ix1 = 0; ix1 < testset.size(); ix1++) {
-    estimatedRT = estimateRT(testset[ix1]->getRetentionFeatures());
-    double diff = estimatedRT - testset[ix1]->getRetentionTime();
+    features[ix1] = testset[ix1]->getRetentionFeatures();
+  }
+  vector<double> estimatedRTs;
+  estimateRTs(features, estimatedRTs);
+  for (size_t ix1 = 0; ix1 < testset.size(); ix1++) {
+    double diff = estimatedRTs[ix1] - testset[ix1]->getRetentionTime();
     rms += diff * diff;
   }
   return rms / testset.size();
@@ -1167,6 +1171,26 @@ double RTModel::estimateRT(double* features) {
   return predicted_value;
 }
 
+// estimate the retention times of many peptides at once, the kernel is
+// evaluated for blocks of peptides against each support vector
+void RTModel::estimateRTs(const vector<double*>& features, 
+                          vector<double>& predictions) {
+  predictions.resize(features.size());
+  if (features.empty()) return;
+  vector<svm_node> nodes(features.size());
+  for (size_t ix = 0; ix < features.size(); ++ix) {
+    nodes[ix].values = features[ix];
+    nodes[ix].dim = noFeaturesToCalc;
+  }
+  svm_predict_batch(model, &nodes[0], static_cast<int>(nodes.size()), 
+                    &predictions[0]);
+  for (size_t ix = 0; ix < predictions.size(); ++ix) {
+    if (!isfinite(predictions[ix])) {
+      predictions[ix] = 0.0;
+    }
+  }
+}
+
 /*
  * EXPERIMENTAL - try to train a hydrophobicity scale using a linear SVR; the weights will give the "hydrophobicity" of each aa
  * Since it is just an experimental try, everything is put in just one function
@@ -1451,7 +1475,7 @@ void RTModel::computeHydrophobicityIndex(vector<PSMDescription*> & psms) {
   normalizer = Normalizer::getNormalizer();
   normalizer->resizeVecs(noFeat);
   // scale the values of the features between 0 and 1
-  vector<double*> tmp;
+  vector<FeatureValue*> tmp;
   vector<double*> tRetFeat = PSMDescriptionDOC::getRetFeatures(psms);
   normalizer->setSet(tmp, tRetFeat, (size_t)0, noFeat);
   normalizer->normalizeSet(tmp, tRetFeat);
@@ -113,6 +113,9 @@ class RTModel {
     // estima rt using a trained model
     double testRetention(vector<PSMDescription*>& testset);
     double estimateRT(double* features);
+    // batch version of estimateRT, predictions[i] is the rt of features[i]
+    void estimateRTs(const vector<double*>& features, 
+                     vector<double>& predictions);
     // load, save, copy and destroy the svr model
     void loadSVRModel(string modelFile, Normalizer* theNormalizer);
     void saveSVRModel(string modelFile, Normalizer* theNormalizer);
@@ -15,6 +15,8 @@
 
  *******************************************************************************/
 
+#include <algorithm>
+
 #include "FeatureMemoryPool.h"
 
 void FeatureMemoryPool::createPool(size_t numFeatures) {
@@ -24,7 +26,10 @@ void FeatureMemoryPool::createPool(size_t numFeatures) {
 }
 
 void FeatureMemoryPool::createNewBlock() {
-  double* memStart = new double[numFeatures_ * numRowsPerBlock_]();
+  FeatureValue* memStart = new FeatureValue[numFeatures_ * numRowsPerBlock_]();
+  std::pair<const FeatureValue*, unsigned int> start(memStart, memStarts_.size());
+  sortedStarts_.insert(std::upper_bound(sortedStarts_.begin(), 
+      sortedStarts_.end(), start), start);
   memStarts_.push_back(memStart);
 }
 
@@ -35,14 +40,29 @@ void FeatureMemoryPool::destroyPool() {
       memStarts_.at(i) = NULL;
     }
   }
+  sortedStarts_.clear();
   isInitialized_ = false;
 }
 
-double* FeatureMemoryPool::addressFromIdx(unsigned int i) const {
+FeatureValue* FeatureMemoryPool::addressFromIdx(unsigned int i) const {
   return memStarts_.at(i / numRowsPerBlock_) + (i % numRowsPerBlock_) * numFeatures_;
 }
 
-double* FeatureMemoryPool::allocate() {
+unsigned int FeatureMemoryPool::indexFromAddress(const FeatureValue* p) const {
+  std::vector<std::pair<const FeatureValue*, unsigned int> >::const_iterator it = 
+      std::upper_bound(sortedStarts_.begin(), sortedStarts_.end(), 
+                       std::make_pair(p, ~0u));
+  --it;
+  return it->second * numRowsPerBlock_ + (p - it->first) / numFeatures_;
+}
+
+unsigned int FeatureMemoryPool::getNumRowsInBlock(size_t i) const {
+  unsigned int firstRow = i * numRowsPerBlock_;
+  if (initializedRows_ <= firstRow) return 0u;
+  return std::min(numRowsPerBlock_, initializedRows_ - firstRow);
+}
+
+FeatureValue* FeatureMemoryPool::allocate() {
   if (freeRows_.size() == 0) {
     if (initializedRows_ >= numRowsPerBlock_ * memStarts_.size()) {
       createNewBlock();
@@ -50,11 +70,11 @@ double* FeatureMemoryPool::allocate() {
     freeRows_.push_back(addressFromIdx(initializedRows_));
     initializedRows_++;
   }
-  double* ret = freeRows_.back();
+  FeatureValue* ret = freeRows_.back();
   freeRows_.pop_back();
   return ret;
 }
 
-void FeatureMemoryPool::deallocate(double* p) {
+void FeatureMemoryPool::deallocate(FeatureValue* p) {
   freeRows_.push_back(p);
 }
@@ -21,13 +21,24 @@
 
 #include <vector>
 #include <iostream>
+#include <utility>
+
+// type of the stored feature values, built with -DFLOAT_FEATURES=ON the 
+// features take half the memory; sums over them are still done in double
+#ifdef FLOAT_FEATURES
+typedef float FeatureValue;
+#else
+typedef double FeatureValue;
+#endif
 
 class FeatureMemoryPool {
  private:
-   static const unsigned int kBlockSize = 65536; // in number of doubles
+   static const unsigned int kBlockSize = 65536; // in number of values
    unsigned int numRowsPerBlock_, numFeatures_, initializedRows_;
-   std::vector<double*> memStarts_;
-   std::vector<double*> freeRows_;
+   std::vector<FeatureValue*> memStarts_;
+   std::vector<FeatureValue*> freeRows_;
+   // block start addresses sorted by address, for indexFromAddress()
+   std::vector<std::pair<const FeatureValue*, unsigned int> > sortedStarts_;
    bool isInitialized_;
  public:
   FeatureMemoryPool() : numRowsPerBlock_(0), numFeatures_(0), 
@@ -40,11 +51,19 @@ class FeatureMemoryPool {
   void destroyPool();
   
   bool isInitialized() const { return isInitialized_; }
+  
+  // direct access to the contiguous blocks of rows, e.g. for bulk updates
+  size_t getNumBlocks() const { return memStarts_.size(); }
+  FeatureValue* getBlock(size_t i) const { return memStarts_[i]; }
+  unsigned int getNumRowsInBlock(size_t i) const;
+  unsigned int getNumFeatures() const { return numFeatures_; }
+  unsigned int getNumRowsPerBlock() const { return numRowsPerBlock_; }
 
-  double* addressFromIdx(unsigned int i) const;
+  FeatureValue* addressFromIdx(unsigned int i) const;
+  unsigned int indexFromAddress(const FeatureValue* p) const;
 
-  double* allocate();
-  void deallocate(double* p);
+  FeatureValue* allocate();
+  void deallocate(FeatureValue* p);
 };
 
 #endif /* FEATURE_MEMORY_POOL_H_ */
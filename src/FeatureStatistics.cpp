@@ -0,0 +1,37 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+#include "FeatureStatistics.h"
+
+void FeatureStatistics::init(size_t numFeatures) {
+  n_ = 0.0;
+  mean_.assign(numFeatures, 0.0);
+  m2_.assign(numFeatures, 0.0);
+  // same starting values as the two-pass UniNormalizer::setSet
+  min_.assign(numFeatures, 1e+100);
+  max_.assign(numFeatures, -1e+100);
+}
+
+double FeatureStatistics::getStdv(size_t ix) const {
+  if (n_ == 0.0 || m2_[ix] <= 0.0) {
+    return 0.0;
+  }
+  return sqrt(m2_[ix] / n_);
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#ifndef FEATURE_STATISTICS_H_
+#define FEATURE_STATISTICS_H_
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+/*
+* FeatureStatistics keeps running per-column statistics (mean, sum of squared
+* deviations, minimum and maximum) of feature rows, so that the normalization
+* factors can be collected while the rows are read in instead of in separate
+* passes afterwards.
+*
+* Rows are added with Welford's update, one at a time as the tab reader 
+* parses them. The reader is serial, so there are no partial statistics to 
+* combine.
+*/
+class FeatureStatistics {
+ public:
+  FeatureStatistics() : n_(0.0) {}
+
+  void init(size_t numFeatures);
+  void clear() { init(mean_.size()); }
+
+  // for feature rows as well as retention feature arrays, the statistics are
+  // accumulated in double precision in both cases
+  template <typename T>
+  void add(const T* features) {
+    n_ += 1.0;
+    const double invN = 1.0 / n_;
+    const size_t numFeatures = mean_.size();
+    for (size_t ix = 0; ix < numFeatures; ++ix) {
+      double x = features[ix];
+      double d = x - mean_[ix];
+      mean_[ix] += d * invN;
+      m2_[ix] += d * (x - mean_[ix]);
+      min_[ix] = std::min(x, min_[ix]);
+      max_[ix] = std::max(x, max_[ix]);
+    }
+  }
+
+  inline size_t getNumFeatures() const { return mean_.size(); }
+  inline double getCount() const { return n_; }
+  inline double getMean(size_t ix) const { return mean_[ix]; }
+  inline double getMin(size_t ix) const { return min_[ix]; }
+  inline double getMax(size_t ix) const { return max_[ix]; }
+  // population standard deviation, as used by StdvNormalizer
+  double getStdv(size_t ix) const;
+
+ protected:
+  double n_;
+  std::vector<double> mean_, m2_, min_, max_;
+};
+
+#endif /* FEATURE_STATISTICS_H_ */
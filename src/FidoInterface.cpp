@@ -16,6 +16,9 @@
  *******************************************************************************/
 
 #include "FidoInterface.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 const double FidoInterface::kPsmThreshold = 0.0;
 const double FidoInterface::kPeptideThreshold = 0.001;
@@ -138,7 +141,7 @@ double FidoInterface::estimatePriors(Scores& peptideScores) {
       double prior = prior_protein * size;
       double tmp_prior = prior;
       // for each protein
-      for(std::vector<std::string>::iterator protIt = psm->pPSM->proteinIds.begin(); 
+      for(std::vector<unsigned int>::iterator protIt = psm->pPSM->proteinIds.begin(); 
 	          protIt != psm->pPSM->proteinIds.end(); protIt++) {
 	      unsigned index = std::distance(psm->pPSM->proteinIds.begin(), protIt);
 	      tmp_prior = (tmp_prior * prior_protein * (size - index)) / (index + 1);
@@ -410,6 +413,14 @@ void FidoInterface::gridSearchOptimize() {
   gridSearch(alpha_search, beta_search, gamma_search);
 }
 
+/**
+ * Evaluates the objective function over the grid. The protein probabilities,
+ * which take most of the time, are computed for as many grid points in 
+ * parallel as there are threads. All threads share proteinGraph_, which is
+ * left unchanged; only the resulting probabilities are kept per thread. The 
+ * objectives are then evaluated in grid order, since they update rocN_ and 
+ * draw random numbers for the pi0 estimate.
+ */
 void FidoInterface::gridSearch(std::vector<double>& alpha_search, 
     std::vector<double>& beta_search, 
     std::vector<double>& gamma_search) {
@@ -417,20 +428,42 @@ void FidoInterface::gridSearch(std::vector<double>& alpha_search,
   double best_objective = -100000000;
   double current_objective;
   
+  std::vector<Model> grid;
   for (unsigned int i = 0; i < gamma_search.size(); i++) {
-    double gamma_local = gamma_search[i];
     for (unsigned int j = 0; j < alpha_search.size(); j++) {
-      double alpha_local = alpha_search[j];
       for (unsigned int k = 0; k < beta_search.size(); k++) {
-        double beta_local = beta_search[k];
-        
-        current_objective = calcObjective(alpha_local, beta_local, gamma_local);
-        if (current_objective > best_objective) {
-          best_objective = current_objective;
-          gamma_best = gamma_local;
-          alpha_best = alpha_local;
-          beta_best = beta_local;
-        }
+        grid.push_back(Model(alpha_search[j], beta_search[k], gamma_search[i]));
+      }
+    }
+  }
+  
+  size_t numSlots = 1u;
+#ifdef _OPENMP
+  numSlots = std::max(1, omp_get_max_threads());
+#endif
+  numSlots = std::min(numSlots, grid.size());
+  if (numSlots == 0u) return;
+  
+  std::vector<std::vector<std::vector<std::string> > > names(numSlots);
+  std::vector<std::vector<double> > probs(numSlots);
+  
+  for (size_t start = 0; start < grid.size(); start += numSlots) {
+    int numPoints = static_cast<int>(std::min(numSlots, grid.size() - start));
+    
+    #pragma omp parallel for schedule(dynamic, 1) if(numPoints > 1)
+    for (int s = 0; s < numPoints; ++s) {
+      proteinGraph_->getProteinProbsAndNames(grid[start + s], names[s], probs[s]);
+    }
+    
+    for (int s = 0; s < numPoints; ++s) {
+      const Model& params = grid[start + s];
+      current_objective = calcObjective(params.alpha, params.beta, 
+                                        params.gamma, names[s], probs[s]);
+      if (current_objective > best_objective) {
+        best_objective = current_objective;
+        gamma_best = params.gamma;
+        alpha_best = params.alpha;
+        beta_best = params.beta;
       }
     }
   }
@@ -439,15 +472,12 @@ void FidoInterface::gridSearch(std::vector<double>& alpha_search,
   gamma_ = gamma_best;
 }
 
-double FidoInterface::calcObjective(double alpha, double beta, double gamma) {
-  std::vector<std::vector<std::string> > names;
-  std::vector<double> probs, empq, estq; 
+double FidoInterface::calcObjective(double alpha, double beta, double gamma,
+    const std::vector<std::vector<std::string> >& names,
+    const std::vector<double>& probs) {
+  std::vector<double> empq, estq; 
   double roc ,mse, objective;
   
-  proteinGraph_->setAlphaBetaGamma(alpha, beta, gamma);
-  proteinGraph_->getProteinProbs();
-  proteinGraph_->getProteinProbsAndNames(names, probs);
-  
   getEstimated_and_Empirical_FDR(names, probs, empq, estq);
   getFDR_MSE(estq, empq, mse);
   getROC_AUC(names, probs, roc);
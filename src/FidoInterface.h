@@ -132,7 +132,9 @@ class FidoInterface : public ProteinProbEstimator {
   void gridSearch(std::vector<double>& alpha_search, 
                   std::vector<double>& beta_search, 
                   std::vector<double>& gamma_search);
-  double calcObjective(double alpha, double beta, double gamma);  
+  double calcObjective(double alpha, double beta, double gamma,
+                       const std::vector<std::vector<std::string> >& names,
+                       const std::vector<double>& probs);
   
 };
 
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+
+#include "LinearScorer.h"
+
+namespace {
+
+const size_t kLanes = LinearScorer::kLanes;
+const size_t kRowBlock = LinearScorer::kRowBlock;
+
+// pairwise reduction of the lane accumulators, identical for every code path
+inline double reduceLanes(const double* acc) {
+  return ((acc[0] + acc[4]) + (acc[2] + acc[6])) +
+         ((acc[1] + acc[5]) + (acc[3] + acc[7]));
+}
+
+inline double dotRow(const FeatureValue* x, const double* w,
+                     size_t numFeatures) {
+  double acc[kLanes] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  size_t j = 0;
+  for (; j + kLanes <= numFeatures; j += kLanes) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      acc[l] += x[j + l] * w[j + l];
+    }
+  }
+  for (size_t l = 0; j + l < numFeatures; ++l) {
+    acc[l] += x[j + l] * w[j + l];
+  }
+  return reduceLanes(acc) + w[numFeatures];
+}
+
+// kRowBlock rows at once, sharing the weight loads; gives the same result
+// per row as dotRow
+inline void dotRowBlock(const FeatureValue* const* x, const double* w,
+                        size_t numFeatures, double* scores) {
+  double acc[kRowBlock][kLanes] = {};
+  size_t j = 0;
+  for (; j + kLanes <= numFeatures; j += kLanes) {
+    for (size_t r = 0; r < kRowBlock; ++r) {
+      for (size_t l = 0; l < kLanes; ++l) {
+        acc[r][l] += x[r][j + l] * w[j + l];
+      }
+    }
+  }
+  for (size_t r = 0; r < kRowBlock; ++r) {
+    for (size_t l = 0; j + l < numFeatures; ++l) {
+      acc[r][l] += x[r][j + l] * w[j + l];
+    }
+    scores[r] = reduceLanes(acc[r]) + w[numFeatures];
+  }
+}
+
+} // namespace
+
+double LinearScorer::score(const FeatureValue* features, const double* w,
+                           size_t numFeatures) {
+  return dotRow(features, w, numFeatures);
+}
+
+void LinearScorer::scoreRows(const FeatureValue* rows, size_t numRows,
+    size_t rowLength, const double* w, size_t numFeatures, double* scores) {
+  size_t i = 0;
+  const FeatureValue* x[kRowBlock];
+  for (; i + kRowBlock <= numRows; i += kRowBlock) {
+    for (size_t r = 0; r < kRowBlock; ++r) {
+      x[r] = rows + (i + r) * rowLength;
+    }
+    dotRowBlock(x, w, numFeatures, scores + i);
+  }
+  for (; i < numRows; ++i) {
+    scores[i] = dotRow(rows + i * rowLength, w, numFeatures);
+  }
+}
+
+void LinearScorer::scoreRows(const FeatureValue* const* rows, size_t numRows,
+    const double* w, size_t numFeatures, double* scores) {
+  size_t i = 0;
+  for (; i + kRowBlock <= numRows; i += kRowBlock) {
+    dotRowBlock(rows + i, w, numFeatures, scores + i);
+  }
+  for (; i < numRows; ++i) {
+    scores[i] = dotRow(rows[i], w, numFeatures);
+  }
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#ifndef LINEAR_SCORER_H_
+#define LINEAR_SCORER_H_
+
+#include <cstddef>
+
+#include "FeatureMemoryPool.h"
+
+/*
+* LinearScorer evaluates w.x + b for feature rows, where w holds numFeatures
+* weights followed by the bias term b.
+*
+* The dot products are accumulated in kLanes independent partial sums, which
+* the compiler maps onto SIMD registers (SSE2 by default, AVX2/AVX-512 when
+* compiled for those targets). Rows are processed kRowBlock at a time so that
+* each weight is loaded once per block of rows (blocked GEMV). Every row is
+* summed in the same order irrespective of blocking or threading, so the
+* scores do not depend on the code path or the number of threads. The sums
+* are accumulated in double precision, also for single precision features.
+*/
+class LinearScorer {
+ public:
+  static double score(const FeatureValue* features, const double* w,
+                      size_t numFeatures);
+
+  // scores numRows consecutive rows that start rowLength values apart
+  static void scoreRows(const FeatureValue* rows, size_t numRows,
+                        size_t rowLength, const double* w,
+                        size_t numFeatures, double* scores);
+  // scores the rows pointed to by rows[0], ..., rows[numRows - 1]
+  static void scoreRows(const FeatureValue* const* rows, size_t numRows,
+                        const double* w, size_t numFeatures, double* scores);
+
+  static const size_t kLanes = 8;
+  static const size_t kRowBlock = 4;
+  // below this number of rows, threads are not worth starting
+  static const size_t kMinParallelRows = 8192;
+};
+
+#endif /* LINEAR_SCORER_H_ */
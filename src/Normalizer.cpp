@@ -34,26 +34,32 @@ Normalizer::Normalizer() {
 Normalizer::~Normalizer() {
 }
 
-void Normalizer::normalizeSet(vector<double*>& featuresV,
+void Normalizer::normalizeSet(vector<FeatureValue*>& featuresV,
                               vector<double*>& rtFeaturesV) {
   normalizeSet(featuresV, 0, numFeatures);
   normalizeSet(rtFeaturesV, numFeatures, numRetentionFeatures);
 }
 
-void Normalizer::normalizeSet(vector<double*>& featuresV,
-                              size_t offset, size_t numFeatures) {
-  double* features;
-  vector<double*>::iterator it = featuresV.begin();
-  for (; it != featuresV.end(); ++it) {
-    features = *it;
-    normalize(features, features, offset, numFeatures);
-  }
-}
-
-void Normalizer::normalize(const double* in, double* out, size_t offset,
-                           size_t numFeatures) {
-  for (unsigned int ix = 0; ix < numFeatures; ++ix) {
-    out[ix] = (in[ix] - sub[offset + ix]) / div[offset + ix];
+/**
+ * Normalizes the first numFeatures columns of all rows in the pool, 
+ * processing the blocks of the pool in parallel
+ */
+void Normalizer::normalizeSet(FeatureMemoryPool& featurePool, 
+                              size_t numFeatures) {
+  const size_t rowLength = featurePool.getNumFeatures();
+  const double* pSub = &sub[0];
+  const double* pDiv = &div[0];
+  const int numBlocks = static_cast<int>(featurePool.getNumBlocks());
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int block = 0; block < numBlocks; ++block) {
+    FeatureValue* features = featurePool.getBlock(block);
+    unsigned int numRows = featurePool.getNumRowsInBlock(block);
+    for (unsigned int row = 0; row < numRows; ++row, features += rowLength) {
+      for (size_t ix = 0; ix < numFeatures; ++ix) {
+        features[ix] = static_cast<FeatureValue>(
+            (features[ix] - pSub[ix]) / pDiv[ix]);
+      }
+    }
   }
 }
 
@@ -20,23 +20,42 @@
 #include <vector>
 #include <iostream>
 
+#include "FeatureStatistics.h"
+#include "FeatureMemoryPool.h"
+
 using namespace std;
 
 class Normalizer {
  public:
   virtual ~Normalizer();
-  virtual void setSet(vector<double*>& featuresV,
+  virtual void setSet(vector<FeatureValue*>& featuresV,
                       vector<double*>& rtFeaturesV, size_t numFeatures,
                       size_t numRetentionFeatures) {}
-  virtual void updateSet(vector<double*>& featuresV, size_t offset,
+  virtual void updateSet(vector<FeatureValue*>& featuresV, size_t offset,
                          size_t numFeatures) {}
+  // same as setSet, but from statistics collected while reading the rows
+  virtual void setStatistics(const FeatureStatistics& featureStats,
+                             const FeatureStatistics& rtFeatureStats,
+                             size_t numFeatures,
+                             size_t numRetentionFeatures) {}
   
-  void normalizeSet(vector<double*>& featuresV,
+  void normalizeSet(vector<FeatureValue*>& featuresV,
                     vector<double*>& rtFeaturesV);
-  void normalizeSet(vector<double*>& featuresV,
-                    size_t offset, size_t numFeatures);
-  void normalize(const double* in, double* out, size_t offset,
-                 size_t numFeatures);
+  // used both for feature rows and for retention feature arrays
+  template <typename T>
+  void normalizeSet(vector<T*>& featuresV, size_t offset, size_t numFeatures) {
+    typename vector<T*>::iterator it = featuresV.begin();
+    for (; it != featuresV.end(); ++it) {
+      normalize(*it, *it, offset, numFeatures);
+    }
+  }
+  void normalizeSet(FeatureMemoryPool& featurePool, size_t numFeatures);
+  template <typename T>
+  void normalize(const T* in, T* out, size_t offset, size_t numFeatures) {
+    for (unsigned int ix = 0; ix < numFeatures; ++ix) {
+      out[ix] = static_cast<T>((in[ix] - sub[offset + ix]) / div[offset + ix]);
+    }
+  }
   inline double normalize(const double in, size_t index) {
     return (in - sub[index]) / div[index];
   }
@@ -22,6 +22,8 @@
 #include <iostream>
 
 #include "Enzyme.h"
+#include "FeatureMemoryPool.h"
+#include "StringInterner.h"
 
 /*
 * PSMDescription
@@ -41,7 +43,7 @@ class PSMDescription {
   virtual void deleteRetentionFeatures() {}
   
   void clear() { proteinIds.clear(); }
-  double* getFeatures() { return features; }
+  FeatureValue* getFeatures() { return features; }
   
   // TODO: move these static functions somewhere else
   static std::string removePTMs(const std::string& peptideSeq);
@@ -63,6 +65,20 @@ class PSMDescription {
   friend std::ostream& operator<<(std::ostream& out, PSMDescription& psm);
   void printProteins(std::ostream& out);
   
+  // protein ids are interned, proteinIds holds indices into proteinIdTable_
+  inline void addProteinId(const std::string& proteinId) {
+    proteinIds.push_back(internProteinId(proteinId));
+  }
+  static inline unsigned int internProteinId(const std::string& proteinId) {
+    return proteinIdTable_.intern(proteinId);
+  }
+  static inline const std::string& getProteinIdString(unsigned int id) {
+    return proteinIdTable_.getString(id);
+  }
+  static inline unsigned int getNumProteinIdStrings() {
+    return static_cast<unsigned int>(proteinIdTable_.size());
+  }
+  
   bool operator<(const PSMDescription& other) const {
     return (peptide < other.peptide) || 
            (peptide == other.peptide && getRetentionTime() < other.getRetentionTime());
@@ -115,12 +131,15 @@ class PSMDescription {
     return 0.0; 
   }
   
-  double* features; // owned by a FeatureMemoryPool instance, no need to delete
+  FeatureValue* features; // owned by a FeatureMemoryPool instance, no need to delete
   double expMass, calcMass;
   unsigned int scan;
   std::string id_;
   std::string peptide;
-  std::vector<std::string> proteinIds;
+  std::vector<unsigned int> proteinIds;
+  
+ protected:
+  static StringInterner proteinIdTable_;
 };
 
 inline std::ostream& operator<<(std::ostream& out, PSMDescription& psm) {
@@ -22,13 +22,14 @@ using namespace PercolatorCrux;
 PickedProteinInterface::PickedProteinInterface(const std::string& fastaDatabase,
     double pvalueCutoff, bool reportFragmentProteins, bool reportDuplicateProteins,
     bool trivialGrouping, double absenceRatio, bool outputEmpirQval, 
-    std::string& decoyPattern, double specCountQvalThreshold) :
+    std::string& decoyPattern, double specCountQvalThreshold, 
+    bool useDigestCache) :
       ProteinProbEstimator(trivialGrouping, absenceRatio, outputEmpirQval, 
                            decoyPattern, specCountQvalThreshold),
-      fastaProteinFN_(fastaDatabase), maxPeptidePval_(pvalueCutoff),
+      protInferenceMethod_(BESTPEPT), fastaProteinFN_(fastaDatabase),
       reportFragmentProteins_(reportFragmentProteins),
       reportDuplicateProteins_(reportDuplicateProteins),
-      protInferenceMethod_(BESTPEPT) {
+      useDigestCache_(useDigestCache), maxPeptidePval_(pvalueCutoff) {
   if (absenceRatio == 1.0) usePi0_ = false;
 }
 
@@ -207,7 +208,15 @@ void PickedProteinInterface::groupProteins(Scores& peptideScores,
   std::map<std::string, std::string> fragment_map, duplicate_map;
   if (fastaProteinFN_ != "auto") {
     pickedProteinCaller.setFastaDatabase(fastaProteinFN_, decoyPattern_);
-    
+  }
+  
+  if (fastaProteinFN_ != "auto" && useDigestCache_ && 
+        pickedProteinCaller.readDigestCache(fragment_map, duplicate_map)) {
+    if (VERB > 1) {
+      std::cerr << "Read protein fragments/duplicates from digest cache " 
+                << pickedProteinCaller.getDigestCacheFile() << std::endl;
+    }
+  } else if (fastaProteinFN_ != "auto") {
     if (VERB > 1) {
       std::cerr << "Detecting protein fragments/duplicates in target database" << std::endl;
     }
@@ -242,90 +251,134 @@ void PickedProteinInterface::groupProteins(Scores& peptideScores,
       std::cerr << "Decoy proteins detected in fasta database, "
                 << "no need to generate decoy database" << std::endl;
     }
+    
+    if (useDigestCache_ && !fail) {
+      if (pickedProteinCaller.writeDigestCache(fragment_map, duplicate_map)) {
+        if (VERB > 1) {
+          std::cerr << "Wrote protein fragments/duplicates to digest cache " 
+                    << pickedProteinCaller.getDigestCacheFile() << std::endl;
+        }
+      } else if (VERB > 0) {
+        std::cerr << "Warning: could not write the digest cache " 
+                  << pickedProteinCaller.getDigestCacheFile() << std::endl;
+      }
+    }
   }
   
-  std::map<std::string, std::set<std::string> > groupProteinIds;
+  /* Index the protein identifiers of the PSMs, in the order of their
+     interned ids, followed by the representatives of their fragments and
+     duplicates, such that the peptide loop below only handles integers */
+  unsigned int numProteinIds = PSMDescription::getNumProteinIdStrings();
+  StringInterner groupIndex;
+  groupIndex.reserve(numProteinIds + 1);
+  for (unsigned int id = 0; id < numProteinIds; ++id) {
+    groupIndex.intern(PSMDescription::getProteinIdString(id));
+  }
+  std::vector<unsigned int> groupOfProtein(numProteinIds);
+  std::vector<bool> isReported(numProteinIds, true), isMapped(numProteinIds, false);
+  for (unsigned int id = 0; id < numProteinIds; ++id) {
+    groupOfProtein[id] = id;
+  }
+  std::map<std::string, std::string>::const_iterator mapIt;
+  for (mapIt = fragment_map.begin(); mapIt != fragment_map.end(); ++mapIt) {
+    int id = groupIndex.find(mapIt->first);
+    if (id != StringInterner::kNotFound && id < (int)numProteinIds) {
+      groupOfProtein[id] = groupIndex.intern(mapIt->second);
+      isReported[id] = reportFragmentProteins_;
+      isMapped[id] = true;
+    }
+  }
+  for (mapIt = duplicate_map.begin(); mapIt != duplicate_map.end(); ++mapIt) {
+    int id = groupIndex.find(mapIt->first);
+    if (id != StringInterner::kNotFound && id < (int)numProteinIds && !isMapped[id]) {
+      groupOfProtein[id] = groupIndex.intern(mapIt->second);
+      isReported[id] = reportDuplicateProteins_;
+    }
+  }
+  unsigned int emptyGroup = groupIndex.intern("", 0); // PSMs without proteins
+  
+  std::vector<int> groupToProteinIdx(groupIndex.size(), -1);
+  std::map<unsigned int, std::vector<unsigned int> > groupProteinIds;
+  std::vector<unsigned int> proteinsInGroup;
   unsigned int numGroups = 0;
   for (vector<ScoreHolder>::iterator peptideIt = peptideScores.begin(); 
           peptideIt != peptideScores.end(); ++peptideIt) {
-    std::string lastProteinId;
-    std::set<std::string> proteinsInGroup;
+    unsigned int lastGroup = emptyGroup;
     bool isFirst = true, isShared = false;
     
     if (peptideIt->p > maxPeptidePval_) continue;
     
-    for (std::vector<std::string>::iterator protIt = peptideIt->pPSM->proteinIds.begin(); 
+    proteinsInGroup.clear();
+    for (std::vector<unsigned int>::iterator protIt = peptideIt->pPSM->proteinIds.begin(); 
             protIt != peptideIt->pPSM->proteinIds.end(); protIt++) {
-      std::string proteinId = *protIt;
-      
-      if (fragment_map.find(proteinId) != fragment_map.end()) {
-        if (reportFragmentProteins_) proteinsInGroup.insert(*protIt);
-        proteinId = fragment_map[proteinId];
-      } else if (duplicate_map.find(proteinId) != duplicate_map.end()) {
-        if (reportDuplicateProteins_) proteinsInGroup.insert(*protIt);
-        proteinId = duplicate_map[proteinId];
-      } else {
-        proteinsInGroup.insert(*protIt);
-      }
+      if (isReported[*protIt]) proteinsInGroup.push_back(*protIt);
+      unsigned int group = groupOfProtein[*protIt];
       
       if (isFirst) {
-        lastProteinId = proteinId;
+        lastGroup = group;
         isFirst = false;
-      } else if (lastProteinId != proteinId) {
+      } else if (lastGroup != group) {
         isShared = true;
         break;
       }
     }
+    if (isShared) continue;
     
+    std::sort(proteinsInGroup.begin(), proteinsInGroup.end());
+    proteinsInGroup.erase(std::unique(proteinsInGroup.begin(), 
+        proteinsInGroup.end()), proteinsInGroup.end());
     if (proteinsInGroup.size() == 1) {
-      lastProteinId = *(proteinsInGroup.begin());
+      lastGroup = proteinsInGroup.front();
     }
     
-    if (!isShared) {
-      ProteinScoreHolder::Peptide peptide(peptideIt->pPSM->getPeptideSequence(), 
-          peptideIt->isDecoy(), peptideIt->p, peptideIt->pep, peptideIt->q, peptideIt->score);
-      if (proteinToIdxMap_.find(lastProteinId) == proteinToIdxMap_.end()) {
-        if (proteinsInGroup.size() > 1) {
-          groupProteinIds[lastProteinId] = proteinsInGroup;
-        }
-        ProteinScoreHolder newProtein(lastProteinId, peptideIt->isDecoy(),
-            peptide, ++numGroups);
-        proteinToIdxMap_[lastProteinId] = proteins_.size();
-        proteins_.push_back(newProtein);
-        if (lastProteinId.find(decoyPattern_) == std::string::npos) {
-          ++numberTargetProteins_;
-        } else {
-          ++numberDecoyProteins_;
-        }
+    ProteinScoreHolder::Peptide peptide(peptideIt->pPSM->getPeptideSequence(), 
+        peptideIt->isDecoy(), peptideIt->p, peptideIt->pep, peptideIt->q, peptideIt->score);
+    if (groupToProteinIdx[lastGroup] < 0) {
+      std::string lastProteinId = groupIndex.getString(lastGroup);
+      if (proteinsInGroup.size() > 1) {
+        groupProteinIds[lastGroup] = proteinsInGroup;
+      }
+      ProteinScoreHolder newProtein(lastProteinId, peptideIt->isDecoy(),
+          peptide, ++numGroups);
+      groupToProteinIdx[lastGroup] = proteins_.size();
+      proteinToIdxMap_[lastProteinId] = proteins_.size();
+      proteins_.push_back(newProtein);
+      if (lastProteinId.find(decoyPattern_) == std::string::npos) {
+        ++numberTargetProteins_;
       } else {
-        proteins_.at(proteinToIdxMap_[lastProteinId]).addPeptide(peptide);
-        if (proteinsInGroup.size() > 1) {
-          groupProteinIds[lastProteinId].insert(proteinsInGroup.begin(), 
-                                                 proteinsInGroup.end());
-        }
+        ++numberDecoyProteins_;
+      }
+    } else {
+      proteins_.at(groupToProteinIdx[lastGroup]).addPeptide(peptide);
+      if (proteinsInGroup.size() > 1) {
+        std::vector<unsigned int>& groupIds = groupProteinIds[lastGroup];
+        groupIds.insert(groupIds.end(), proteinsInGroup.begin(), 
+                        proteinsInGroup.end());
       }
     }
   }
   
   /* Update protein group identifier to include fragment and duplicate protein identifiers */
   if (reportFragmentProteins_ || reportDuplicateProteins_) {
-    std::map<std::string, std::set<std::string> >::iterator groupIt;
-    std::map<std::string, size_t>::iterator representIt;
+    std::map<unsigned int, std::vector<unsigned int> >::iterator groupIt;
     for (groupIt = groupProteinIds.begin(); groupIt != groupProteinIds.end(); ++groupIt) {
-      representIt = proteinToIdxMap_.find(groupIt->first);
-      if (representIt != proteinToIdxMap_.end()) { /* these are the protein group representatives */
-        std::string newName = "";
-        for (std::set<std::string>::iterator proteinIt = groupIt->second.begin(); proteinIt != groupIt->second.end(); ++proteinIt) {
-          /* some protein identifiers contain commas, replace them by the much 
-             less used semicolon as the comma is used to separate protein 
-             identifiers */
-          std::string proteinId = *proteinIt;
-          std::replace(proteinId.begin(), proteinId.end(), ',', ';'); 
-          newName += proteinId + ",";
-        }
-        newName = newName.substr(0, newName.size() - 1); // remove last comma
-        proteins_.at(representIt->second).setName(newName);
+      /* these are the protein group representatives */
+      std::set<std::string> proteinIds;
+      for (std::vector<unsigned int>::const_iterator idIt = groupIt->second.begin(); 
+             idIt != groupIt->second.end(); ++idIt) {
+        proteinIds.insert(PSMDescription::getProteinIdString(*idIt));
+      }
+      std::string newName = "";
+      for (std::set<std::string>::iterator proteinIt = proteinIds.begin(); proteinIt != proteinIds.end(); ++proteinIt) {
+        /* some protein identifiers contain commas, replace them by the much 
+           less used semicolon as the comma is used to separate protein 
+           identifiers */
+        std::string proteinId = *proteinIt;
+        std::replace(proteinId.begin(), proteinId.end(), ',', ';'); 
+        newName += proteinId + ",";
       }
+      newName = newName.substr(0, newName.size() - 1); // remove last comma
+      proteins_.at(groupToProteinIdx[groupIt->first]).setName(newName);
     }
   }
 }
@@ -381,50 +434,60 @@ void PickedProteinInterface::computeProbabilities(const std::string& fname) {
   estimatePEPs();
 }
 
-bool PickedProteinInterface::pickedProteinCheckId(std::string& proteinId, bool isDecoy,
-    std::set<std::string>& targetProts, std::set<std::string>& decoyProts) {
+bool PickedProteinInterface::pickedProteinCheckId(const char* proteinId, 
+    size_t length, bool isDecoy, StringInterner& targetProts, 
+    StringInterner& decoyProts, std::string& buffer) {
   bool found = false;
   if (isDecoy) {
-    std::string targetId = proteinId;
-    if (decoyPattern_.size() >= proteinId.size()) {
+    const char* targetId = proteinId;
+    size_t targetLength = length;
+    if (decoyPattern_.size() >= length) {
       ostringstream oss;
       oss << "ERROR: Could not detect the decoy prefix \"" << decoyPattern_ 
-          << "\" for the decoy protein identifier \"" << proteinId << "\"." << std::endl;
+          << "\" for the decoy protein identifier \"" 
+          << std::string(proteinId, length) << "\"." << std::endl;
       if (NO_TERMINATE) {
         std::cerr << oss.str() << "No-terminate flag set: ignoring error and skipping removal of decoyPrefix." << std::endl;
       } else {
         throw MyException(oss.str());
       }
     } else {
-      targetId = proteinId.substr(decoyPattern_.size());
+      targetId += decoyPattern_.size();
+      targetLength -= decoyPattern_.size();
     }
-    if (targetProts.find(targetId) != targetProts.end()) {
+    if (targetProts.find(targetId, targetLength) != StringInterner::kNotFound) {
       found = true;
     } else {
-      decoyProts.insert(proteinId);
+      decoyProts.intern(proteinId, length);
     }
   } else {
-    if (decoyProts.find(decoyPattern_ + proteinId) != decoyProts.end()) {
+    buffer.assign(decoyPattern_);
+    buffer.append(proteinId, length);
+    if (decoyProts.find(buffer) != StringInterner::kNotFound) {
       found = true;
     } else {
-      targetProts.insert(proteinId);
+      targetProts.intern(proteinId, length);
     }
   }
   return found;
 }
 
-bool PickedProteinInterface::pickedProteinCheck(std::string& proteinName, bool isDecoy, 
-    std::set<std::string>& targetProts, std::set<std::string>& decoyProts) {
+bool PickedProteinInterface::pickedProteinCheck(const std::string& proteinName, 
+    bool isDecoy, StringInterner& targetProts, StringInterner& decoyProts,
+    std::string& buffer) {
   bool erase = false;
   if (reportFragmentProteins_ || reportDuplicateProteins_) {
-    std::istringstream ss(proteinName); 
-    std::string proteinId;
-    while (std::getline(ss, proteinId, ',')) { // split name by comma
-      erase = erase || pickedProteinCheckId(proteinId, isDecoy, 
-                                          targetProts, decoyProts);
+    const char* proteinId = proteinName.data();
+    const char* nameEnd = proteinId + proteinName.size();
+    while (proteinId < nameEnd) { // split name by comma
+      const char* idEnd = std::find(proteinId, nameEnd, ',');
+      erase = erase || pickedProteinCheckId(proteinId, idEnd - proteinId, 
+                           isDecoy, targetProts, decoyProts, buffer);
+      proteinId = idEnd + 1;
     }
   } else {
-    erase = pickedProteinCheckId(proteinName, isDecoy, targetProts, decoyProts);
+    erase = pickedProteinCheckId(proteinName.data(), proteinName.size(), 
+                                 isDecoy, targetProts, decoyProts, buffer);
   }
   return erase;
 }
@@ -438,7 +501,8 @@ void PickedProteinInterface::pickedProteinStrategy() {
   }
   
   std::vector<ProteinScoreHolder> pickedProtIdProtPairs;
-  std::set<std::string> targetProts, decoyProts;
+  StringInterner targetProts, decoyProts;
+  std::string buffer;
   std::vector<ProteinScoreHolder>::iterator it = proteins_.begin();
   size_t numErased = 0;
   // TODO: what about peptides with both target and decoy proteins?
@@ -446,7 +510,8 @@ void PickedProteinInterface::pickedProteinStrategy() {
     bool isDecoy = it->isDecoy();
     std::string proteinName = it->getName(); 
     
-    bool erase = pickedProteinCheck(proteinName, isDecoy, targetProts, decoyProts);
+    bool erase = pickedProteinCheck(proteinName, isDecoy, targetProts, 
+                                    decoyProts, buffer);
     if (erase) {
       if (isDecoy) --numberDecoyProteins_;
       else --numberTargetProteins_;
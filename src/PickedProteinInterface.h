@@ -27,6 +27,7 @@
 #include "ProteinProbEstimator.h"
 #include "PosteriorEstimator.h"
 #include "PickedProteinCaller.h"
+#include "StringInterner.h"
 #include "Enzyme.h"
 #include "PseudoRandom.h"
 
@@ -58,7 +59,7 @@ class PickedProteinInterface : public ProteinProbEstimator {
     bool reportFragmentProteins, bool reportDuplicateProteins, 
     bool trivialGrouping, double absenceRatio, 
     bool outputEmpirQval, std::string& decoyPattern,
-    double specCountQvalThreshold);
+    double specCountQvalThreshold, bool useDigestCache = false);
   virtual ~PickedProteinInterface();
   
   bool initialize(Scores& fullset, const Enzyme* enzyme);
@@ -73,16 +74,19 @@ class PickedProteinInterface : public ProteinProbEstimator {
     PickedProteinCaller& pickedProteinCaller);
   
   void pickedProteinStrategy();
-  bool pickedProteinCheckId(std::string& proteinId, bool isDecoy,
-    std::set<std::string>& targetProts, std::set<std::string>& decoyProts);
-  bool pickedProteinCheck(std::string& proteinName, bool isDecoy, 
-    std::set<std::string>& targetProts, std::set<std::string>& decoyProts);
+  bool pickedProteinCheckId(const char* proteinId, size_t length, 
+    bool isDecoy, StringInterner& targetProts, StringInterner& decoyProts,
+    std::string& buffer);
+  bool pickedProteinCheck(const std::string& proteinName, bool isDecoy, 
+    StringInterner& targetProts, StringInterner& decoyProts, 
+    std::string& buffer);
   void estimatePEPs();
   
   /** PICKED_PROTEIN PARAMETERS **/
   ProteinInferenceMethod protInferenceMethod_;
   std::string fastaProteinFN_;
   bool reportFragmentProteins_, reportDuplicateProteins_;
+  bool useDigestCache_;
   double maxPeptidePval_;
   
 };
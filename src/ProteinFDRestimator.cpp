@@ -51,15 +51,7 @@
 #include <iostream>
 #include <algorithm>
 #include <ProteinFDRestimator.h>
-
-struct RetrieveValue
-{
-  template <typename T>
-  typename T::second_type operator()(T keyValuePair) const
-  {
-    return keyValuePair.second;
-  }
-};
+#include "StringHash.h"
 
 /** external functions used to estimate the expexted value of the hypergeometric distribution **/
 
@@ -110,59 +102,67 @@ ProteinFDRestimator::ProteinFDRestimator(std::string __decoy_prefix,unsigned __n
 
 ProteinFDRestimator::~ProteinFDRestimator()
 {
-  FreeAll(binnedProteins);
-  FreeAll(groupedProteins);
+  FreeAll(entryProteins);
   FreeAll(lengths);
+  FreeAll(rangeOffsets);
+  FreeAll(binRanges);
+  FreeAll(binSizes);
 }
 
 
-void ProteinFDRestimator::correctIdenticalSequences(const std::map<std::string,std::pair<std::string,double> > &targetProteins,
-						       const std::map<std::string,std::pair<std::string,double> > &decoyProteins)
+/** two 64-bit hashes of the residues with different multipliers, mixed into each other at the end **/
+SequenceFingerprint ProteinFDRestimator::fingerprintSequence(const std::string &sequence)
+{
+  uint64_t high = kFnvOffsetBasis;
+  uint64_t low = 0x9e3779b97f4a7c15ULL;
+  for(std::string::const_iterator it = sequence.begin(); it != sequence.end(); it++)
+  {
+    uint64_t residue = static_cast<unsigned char>(*it);
+    high = (high ^ residue) * kFnvPrime;
+    low = (low ^ residue) * 0x87c37b91114253d5ULL;
+  }
+  high = mixHash(high ^ sequence.size());
+  low = mixHash(low + sequence.size());
+  SequenceFingerprint fingerprint;
+  fingerprint.high = high + low;
+  fingerprint.low = low + fingerprint.high;
+  return fingerprint;
+}
+
+void ProteinFDRestimator::correctIdenticalSequences(const std::map<std::string,std::pair<SequenceFingerprint,double> > &targetProteins,
+						       const std::map<std::string,std::pair<SequenceFingerprint,double> > &decoyProteins)
 {
-  std::map<std::string,std::pair<std::string,double> >::const_iterator it,it2;
+  std::map<std::string,std::pair<SequenceFingerprint,double> >::const_iterator it;
   
-  groupedProteins.clear();
+  proteinIds.clear();
+  entryProteins.clear();
   lengths.clear();
-  it = targetProteins.begin();
-  it2 = decoyProteins.begin();
-  unsigned num_corrected = 0;
-  std::set<std::string> previouSeqs;
-  double length = 0.0;
+  std::vector<std::pair<SequenceFingerprint,unsigned> > fingerprints;
+  fingerprints.reserve(targetProteins.size() + decoyProteins.size());
   
   for(it = targetProteins.begin(); it != targetProteins.end(); it++)
   {
-    std::string targetSeq = (*it).second.first;
-    std::string targetName = (*it).first;
-    if(previouSeqs.find(targetSeq) != previouSeqs.end())
-    {
-      length = 0.0;
-      num_corrected++;
-    }
-    else
-    {
-      length = (*it).second.second;
-      previouSeqs.insert(targetSeq);
-    }
-    groupedProteins.insert(std::make_pair(length,targetName));
-    lengths.push_back(length);
+    fingerprints.push_back(std::make_pair((*it).second.first,(unsigned)lengths.size()));
+    entryProteins.push_back(proteinIds.intern((*it).first));
+    lengths.push_back((*it).second.second);
+  }
+  for(it = decoyProteins.begin(); it != decoyProteins.end(); it++)
+  {
+    fingerprints.push_back(std::make_pair((*it).second.first,(unsigned)lengths.size()));
+    entryProteins.push_back(proteinIds.intern((*it).first));
+    lengths.push_back((*it).second.second);
   }
   
-  for(it2 = decoyProteins.begin(); it2 != decoyProteins.end(); it2++)
+  //within a run of identical fingerprints the first entry, targets before decoys, keeps its length
+  std::sort(fingerprints.begin(),fingerprints.end());
+  unsigned num_corrected = 0;
+  for(unsigned k = 1; k < fingerprints.size(); k++)
   {
-    std::string decoySeq = (*it2).second.first;
-    std::string decoyName = (*it2).first;
-    if(previouSeqs.find(decoySeq) != previouSeqs.end())
+    if(fingerprints[k].first == fingerprints[k-1].first)
     {
-      length = 0.0;
+      lengths[fingerprints[k].second] = 0.0;
       num_corrected++;
     }
-    else
-    {
-      length = (*it2).second.second;
-      previouSeqs.insert(decoySeq);
-    }
-    groupedProteins.insert(std::make_pair(length,decoyName));
-    lengths.push_back(length);
   }
   
   if(VERB > 2)
@@ -178,7 +178,28 @@ void ProteinFDRestimator::groupProteinsGene()
 }
 
 
+int ProteinFDRestimator::getProteinId(const std::string &protein)
+{
+  return proteinIds.find(protein);
+}
+
 double ProteinFDRestimator::estimateFDR(const std::set<std::string> &__target, const std::set<std::string> &__decoy)
+{
+  std::vector<unsigned> targetIds, decoyIds;
+  for(std::set<std::string>::const_iterator it = __target.begin(); it != __target.end(); it++)
+  {
+    int id = getProteinId(*it);
+    if(id != StringInterner::kNotFound) targetIds.push_back(id);
+  }
+  for(std::set<std::string>::const_iterator it = __decoy.begin(); it != __decoy.end(); it++)
+  {
+    int id = getProteinId(*it);
+    if(id != StringInterner::kNotFound) decoyIds.push_back(id);
+  }
+  return estimateFDR(targetIds,decoyIds);
+}
+
+double ProteinFDRestimator::estimateFDR(const std::vector<unsigned> &__targetIds, const std::vector<unsigned> &__decoyIds)
 {   
   
     time_t startTime;
@@ -186,10 +207,6 @@ double ProteinFDRestimator::estimateFDR(const std::set<std::string> &__target, c
     time(&startTime);
     startClock = clock();
     
-    if(binnedProteins.size() > 0)
-    {
-       FreeAll(binnedProteins);
-    } 
     if(binequalDeepth)
     {
       binProteinsEqualDeepth();
@@ -201,15 +218,18 @@ double ProteinFDRestimator::estimateFDR(const std::set<std::string> &__target, c
     
     if(VERB > 2)
     {
-      std::cerr << "\nThere are : " << __target.size() << " target proteins and " << __decoy.size() 
+      std::cerr << "\nThere are : " << __targetIds.size() << " target proteins and " << __decoyIds.size() 
       << " decoys proteins that contains high confident PSMs\n" << std::endl;    
     }
 
+    std::vector<unsigned> numbersTP, numbersFP;
+    countProteins(__targetIds,numbersTP);
+    countProteins(__decoyIds,numbersFP);
     double fptol = 0.0;
     for(unsigned i = 0; i < nbins; i++)
     {
-      unsigned numberTP = countProteins(i,__target);
-      unsigned numberFP = countProteins(i,__decoy);
+      unsigned numberTP = numbersTP[i];
+      unsigned numberFP = numbersFP[i];
       unsigned N = getBinProteins(i);
       double fp = estimatePi0HG(N,numberTP,static_cast<unsigned int>(targetDecoyRatio*numberFP));
       
@@ -234,97 +254,147 @@ double ProteinFDRestimator::estimateFDR(const std::set<std::string> &__target, c
     return fptol ;
 }
 
-
+/** selects the order statistics with nth_element instead of sorting all lengths; 
+ * the ranks are clamped to the last length **/
+void ProteinFDRestimator::selectLengths(const std::vector<size_t> &ranks, std::vector<double> &values)
+{
+  std::vector<double> sorted(lengths);
+  values.clear();
+  std::vector<double>::iterator first = sorted.begin();
+  for(unsigned i = 0; i < ranks.size(); i++)
+  {
+    std::vector<double>::iterator nth = sorted.begin() + std::min(ranks[i], sorted.size() - 1);
+    if(nth >= first)
+    {
+      std::nth_element(first, nth, sorted.end());
+      first = nth;
+    }
+    values.push_back(*nth);
+  }
+}
 
 void ProteinFDRestimator::binProteinsEqualDeepth()
 {
-  //assuming lengths sorted from less to bigger
-  std::sort(lengths.begin(),lengths.end());
   unsigned entries = lengths.size();
+  if(entries == 0)
+  {
+    binProteins(std::vector<double>());
+    return;
+  }
   //integer divion and its residue
   unsigned nr_bins = (unsigned)((entries - entries%nbins) / nbins);
   unsigned residues = entries % nbins;
   if(VERB > 2)
     std::cerr << "\nBinning proteins using equal deepth\n" << std::endl;
   
-  /*while(residues >= nbins && residues != 0)
+  std::vector<size_t> ranks;
+  for(unsigned i = 0; i <= nbins; i++)
   {
-    nr_bins += (unsigned)((residues - residues%nbins) / nbins);
-    residues = residues % nbins; 
-  }*/
-  
+    ranks.push_back((unsigned)(nr_bins * i));
+  }
   std::vector<double> values;
-  for(unsigned i = 0; i <= nbins; i++)
+  selectLengths(ranks,values);
+  if(VERB > 2)
   {
-    unsigned index = (unsigned)(nr_bins * i);
-    double value = lengths[index];
-    values.push_back(value);
-    if(VERB > 2)
-      std::cerr << "\nValue of bin : " << i << " with index " << index << " is " << value << std::endl;
+    for(unsigned i = 0; i <= nbins; i++)
+      std::cerr << "\nValue of bin : " << i << " with index " << ranks[i] << " is " << values[i] << std::endl;
   }
   
   //there are some elements at the end that are <= nbins that could not be fitted
-  //FIXME I think it fails if it enters here in some scenarios
-  
   if(residues > 0)
   {
-    values.back() = lengths.back();
+    values.back() = *std::max_element(lengths.begin(),lengths.end());
     if(VERB > 2)
       std::cerr << "\nValue of last bin is fixed to : " << values.back() << std::endl;
   }
 
-  std::multimap<double,std::string>::iterator itlow,itup;
-  for(unsigned i = 0; i < nbins; i++)
-  {
-    double lowerbound = values[i];
-    double upperbound = values[i+1];
-    itlow = groupedProteins.lower_bound(lowerbound);
-    itup =  groupedProteins.upper_bound(upperbound);
-    std::set<std::string> proteins;
-    std::transform(itlow, itup, std::inserter(proteins,proteins.begin()), RetrieveValue());
-    binnedProteins.insert(std::make_pair(i,proteins));
-  }
-
+  binProteins(values);
   return;
 }
     
 void ProteinFDRestimator::binProteinsEqualWidth()
 {
-  //assuming lengths sorted from less to bigger
-  std::sort(lengths.begin(),lengths.end());
-  double min = lengths.front();
-  double max = lengths.back();
-  std::vector<double> values;
+  if(lengths.empty())
+  {
+    binProteins(std::vector<double>());
+    return;
+  }
+  double min = *std::min_element(lengths.begin(),lengths.end());
+  double max = *std::max_element(lengths.begin(),lengths.end());
   double span = abs(max - min);
   double part = span / nbins;
   
   if (VERB > 2)
     std::cerr << "\nBinning proteins using equal width\n" << std::endl;
   
+  std::vector<size_t> ranks;
   for(unsigned i = 0; i < nbins; i++)
   {
-    unsigned index = static_cast<unsigned>(min + i*part);
-    double value = lengths[index];
-    values.push_back(value);
-    if(VERB > 2)
-      std::cerr << "\nValue of bin : " << i << " with index " << index << " is " << value << std::endl;
+    ranks.push_back(static_cast<unsigned>(min + i*part));
   }
-  values.push_back(max);
-  std::multimap<double,std::string>::iterator itlow,itup;
-  for(unsigned i = 0; i < nbins; i++)
+  std::vector<double> values;
+  selectLengths(ranks,values);
+  if(VERB > 2)
   {
-    double lowerbound = values[i];
-    double upperbound = values[i+1];
-    itlow = groupedProteins.lower_bound(lowerbound);
-    itup =  groupedProteins.upper_bound(upperbound);
-    std::set<std::string> proteins;
-    std::transform(itlow, itup, std::inserter(proteins,proteins.begin()), RetrieveValue());
-    binnedProteins.insert(std::make_pair(i,proteins));
+    for(unsigned i = 0; i < nbins; i++)
+      std::cerr << "\nValue of bin : " << i << " with index " << ranks[i] << " is " << values[i] << std::endl;
   }
-
+  values.push_back(max);
+  binProteins(values);
   return;
 }
 
+/** assigns each protein to the bins i with values[i] <= length <= values[i+1],
+ * which is a range of consecutive bins as the values are ascending, and counts
+ * the proteins of each bin **/
+void ProteinFDRestimator::binProteins(const std::vector<double> &values)
+{
+  unsigned numProteins = proteinIds.size();
+  unsigned numBins = values.empty() ? 0 : values.size() - 1;
+  // group the ranges of the entries by protein id
+  rangeOffsets.assign(numProteins + 1, 0);
+  for(unsigned k = 0; k < entryProteins.size(); k++)
+    rangeOffsets[entryProteins[k] + 1]++;
+  for(unsigned id = 0; id < numProteins; id++)
+    rangeOffsets[id + 1] += rangeOffsets[id];
+  binRanges.resize(entryProteins.size());
+  std::vector<unsigned> next(rangeOffsets.begin(), rangeOffsets.end() - 1);
+  for(unsigned k = 0; k < entryProteins.size(); k++)
+  {
+    unsigned first = std::lower_bound(values.begin() + (numBins > 0), values.end(), lengths[k]) 
+                     - values.begin() - (numBins > 0);
+    unsigned last = std::upper_bound(values.begin(), values.begin() + numBins, lengths[k]) 
+                    - values.begin();
+    binRanges[next[entryProteins[k]]++] = std::make_pair(first,last);
+  }
+  // a protein that is in both the target and the decoy database counts once per bin
+  unsigned numRanges = 0;
+  for(unsigned id = 0; id < numProteins; id++)
+  {
+    std::vector<std::pair<unsigned,unsigned> >::iterator begin = binRanges.begin() + rangeOffsets[id];
+    std::vector<std::pair<unsigned,unsigned> >::iterator end = binRanges.begin() + rangeOffsets[id + 1];
+    if(end - begin > 1) std::sort(begin,end);
+    rangeOffsets[id] = numRanges;
+    unsigned covered = 0;
+    for(; begin != end; begin++)
+    {
+      unsigned first = std::max(begin->first,covered);
+      if(first < begin->second)
+      {
+        binRanges[numRanges++] = std::make_pair(first,begin->second);
+        covered = begin->second;
+      }
+    }
+  }
+  rangeOffsets[numProteins] = numRanges;
+  binRanges.resize(numRanges);
+  
+  std::vector<unsigned> allIds(numProteins);
+  for(unsigned id = 0; id < numProteins; id++)
+    allIds[id] = id;
+  countProteins(allIds,binSizes);
+}
+
 double ProteinFDRestimator::estimatePi0HG(unsigned N,unsigned targets,unsigned cf)
 {
   std::vector<double> logprob;
@@ -350,26 +420,32 @@ double ProteinFDRestimator::estimatePi0HG(unsigned N,unsigned targets,unsigned c
 
 }
 
-unsigned int ProteinFDRestimator::countProteins(unsigned int bin,const std::set<std::string> &proteins)
+/** histogram of the bins of the given proteins, by marking the start and end of 
+ * each bin range and summing up **/
+void ProteinFDRestimator::countProteins(const std::vector<unsigned> &proteinIds, std::vector<unsigned> &counts)
 {
-  std::set<std::string> proteinsBins = binnedProteins[bin];
-  unsigned count = 0;
-  for(std::set<std::string>::const_iterator it = proteins.begin(); it != proteins.end(); it++)
+  std::vector<int> diff(nbins + 1, 0);
+  for(std::vector<unsigned>::const_iterator it = proteinIds.begin(); it != proteinIds.end(); it++)
   {
-    std::set<std::string>::iterator itfound = proteinsBins.find(*it);
-    if(itfound != proteinsBins.end())
+    for(unsigned r = rangeOffsets[*it]; r < rangeOffsets[*it + 1]; r++)
     {
-      count++;
-      proteinsBins.erase(itfound);
+      diff[binRanges[r].first]++;
+      diff[binRanges[r].second]--;
     }
   }
-  return count;
+  counts.assign(nbins, 0);
+  int count = 0;
+  for(unsigned i = 0; i < nbins; i++)
+  {
+    count += diff[i];
+    counts[i] = count;
+  }
 }
 
 
 unsigned int ProteinFDRestimator::getBinProteins(unsigned int bin)
 {
-  return binnedProteins[bin].size();
+  return bin < binSizes.size() ? binSizes[bin] : 0;
 }
 
 
@@ -57,6 +57,8 @@
 #include <assert.h>
 #include <math.h>
 #include <cmath>
+#include <stdint.h>
+#include "StringInterner.h"
 
 
 template <typename T>
@@ -65,6 +67,19 @@ void FreeAll( T & t ) {
     t.swap( tmp );
 }
 
+/** 128-bit hash of a protein sequence, used to find identical sequences without storing them **/
+struct SequenceFingerprint
+{
+  uint64_t high, low;
+  
+  bool operator<(const SequenceFingerprint &other) const {
+    return high < other.high || (high == other.high && low < other.low);
+  }
+  bool operator==(const SequenceFingerprint &other) const {
+    return high == other.high && low == other.low;
+  }
+};
+
 class ProteinFDRestimator
 {
   
@@ -77,16 +92,24 @@ public:
   /** return the number of proteins in bin i **/
   unsigned getBinProteins(unsigned bin);
   
-  /** return the number of proteins in bin i that are in the list of proteins given **/
-  unsigned countProteins(unsigned bin,const std::set<std::string> &proteins);
+  /** return the id of a protein of the database, or StringInterner::kNotFound **/
+  int getProteinId(const std::string &protein);
+  
+  /** count the proteins with the given ids in each bin **/
+  void countProteins(const std::vector<unsigned> &proteinIds, std::vector<unsigned> &counts);
   
   /** estimate and return the global FDR for a given set of target and decoy proteins **/
   double estimateFDR(const std::set<std::string> &target, const std::set<std::string> &decoy);
+  double estimateFDR(const std::vector<unsigned> &targetIds, const std::vector<unsigned> &decoyIds);
 
   /**This function populates the proteins, proteins with same sequence only the alphabetical ordered first keeps the sequence
-   * the rest of the sequences are set to null. This will keep only 1 protein when there is a degenerated peptide */
-  void correctIdenticalSequences(const std::map<std::string,std::pair<std::string,double> > &targetProteins,
-				   const std::map<std::string,std::pair<std::string,double> > &decoyProteins);
+   * the rest of the sequences are set to null. This will keep only 1 protein when there is a degenerated peptide.
+   * The sequences are compared by their fingerprints */
+  void correctIdenticalSequences(const std::map<std::string,std::pair<SequenceFingerprint,double> > &targetProteins,
+				   const std::map<std::string,std::pair<SequenceFingerprint,double> > &decoyProteins);
+  
+  /** return the fingerprint of a protein sequence **/
+  static SequenceFingerprint fingerprintSequence(const std::string &sequence);
   
   /** SETTERS AND GETTERS **/
   
@@ -108,6 +131,10 @@ private:
   /**bins proteins according to the lenght**/
   void binProteinsEqualDeepth();
   void binProteinsEqualWidth();
+  void binProteins(const std::vector<double> &values);
+  
+  /** the values at the given ranks of the sorted lengths, ranks ascending **/
+  void selectLengths(const std::vector<size_t> &ranks, std::vector<double> &values);
 
   /**group proteins according to genes in order to estimate their lenght, proteins of the same gene group which has a tryptic peptide that has
    already been counted wont count that already counted tryptic peptide to estimate its lenght **/
@@ -125,9 +152,15 @@ private:
   //std::set<std::string> *target;
   //std::set<std::string> *decoy;
   bool binequalDeepth;
-  std::map<unsigned,std::set<std::string> > binnedProteins;
-  std::multimap<double,std::string> groupedProteins;
-  std::vector<double> lengths; 
+  /** the names of the database proteins, numbered by first occurrence **/
+  StringInterner proteinIds;
+  /** protein id and corrected length of the target and decoy entries **/
+  std::vector<unsigned> entryProteins;
+  std::vector<double> lengths;
+  /** the bins of protein id i are the disjoint ranges binRanges[rangeOffsets[i]..rangeOffsets[i+1]) **/
+  std::vector<unsigned> rangeOffsets;
+  std::vector<std::pair<unsigned,unsigned> > binRanges;
+  std::vector<unsigned> binSizes;
 
 };
 #endif /* PROTEINFDRESTIMATOR_H_ */
@@ -20,6 +20,7 @@
 const double ProteinProbEstimator::target_decoy_ratio = 1.0;
 const double ProteinProbEstimator::psmThresholdMayu = 0.90;
 const double ProteinProbEstimator::prior_protein = 0.5;
+const size_t ProteinProbEstimator::kNoProteinIdx;
 bool ProteinProbEstimator::calcProteinLevelProb = false;
 
 ProteinProbEstimator::ProteinProbEstimator(bool trivialGrouping, double absenceRatio, 
@@ -309,27 +310,33 @@ void ProteinProbEstimator::setTargetandDecoysNames(Scores& peptideScores) {
   std::vector<ScoreHolder>::iterator psm = peptideScores.begin();
   for (; psm!= peptideScores.end(); ++psm) {
     // for each protein
-    std::vector<std::string>::iterator protIt = psm->pPSM->proteinIds.begin();
+    std::vector<unsigned int>::const_iterator protIt = psm->pPSM->proteinIds.begin();
     for (; protIt != psm->pPSM->proteinIds.end(); protIt++) {
       ProteinScoreHolder::Peptide peptide(psm->pPSM->getPeptideSequence(), 
           psm->isDecoy(), psm->p, psm->pep, psm->q, psm->score);
-      if (proteinToIdxMap_.find(*protIt) == proteinToIdxMap_.end()) {
-	      ProteinScoreHolder newProtein(*protIt, psm->isDecoy(), peptide, ++numGroups);
-	      proteinToIdxMap_[*protIt] = proteins_.size();
+      if (*protIt >= internedIdToIdx_.size()) {
+        internedIdToIdx_.resize(*protIt + 1, kNoProteinIdx);
+      }
+      if (internedIdToIdx_[*protIt] == kNoProteinIdx) {
+        const std::string& proteinName = 
+            PSMDescription::getProteinIdString(*protIt);
+	      ProteinScoreHolder newProtein(proteinName, psm->isDecoy(), peptide, ++numGroups);
+	      internedIdToIdx_[*protIt] = proteins_.size();
+	      proteinToIdxMap_[proteinName] = proteins_.size();
 	      proteins_.push_back(newProtein);
 	      
 	      if (!useDecoyPrefix) {
 	        if (psm->isDecoy()) {
-	          falsePosSet_.insert(*protIt);
+	          falsePosSet_.insert(proteinName);
 	          decoyFound = true;
 	        } else {
-	          truePosSet_.insert(*protIt);
+	          truePosSet_.insert(proteinName);
 	        }
-	      } else if (isDecoy(*protIt)) {
+	      } else if (isDecoy(proteinName)) {
 	        decoyFound = true;
 	      }
       } else {
-      	proteins_.at(proteinToIdxMap_[*protIt]).addPeptide(peptide);
+      	proteins_.at(internedIdToIdx_[*protIt]).addPeptide(peptide);
       }
     }
   }
@@ -348,17 +355,26 @@ void ProteinProbEstimator::setTargetandDecoysNames(Scores& peptideScores) {
 }
 
 void ProteinProbEstimator::addSpectralCounts(Scores& peptideScores) {
+  // the picked protein method fills proteinToIdxMap_ with its own protein 
+  // names, so resolve each interned protein id against the map once
+  unsigned int numProteinIds = PSMDescription::getNumProteinIdStrings();
+  internedIdToIdx_.assign(numProteinIds, kNoProteinIdx);
+  for (unsigned int id = 0; id < numProteinIds; ++id) {
+    std::map<std::string, size_t>::const_iterator mapIt = 
+        proteinToIdxMap_.find(PSMDescription::getProteinIdString(id));
+    if (mapIt != proteinToIdxMap_.end()) {
+      internedIdToIdx_[id] = mapIt->second;
+    }
+  }
+  
   std::vector<ScoreHolder>::iterator psm = peptideScores.begin();
   for (; psm!= peptideScores.end(); ++psm) {
     // for each protein
-    std::vector<std::string>::const_iterator protIt = psm->pPSM->proteinIds.begin();
+    std::vector<unsigned int>::const_iterator protIt = psm->pPSM->proteinIds.begin();
     std::set<unsigned int> seenProteinIdxs;
     for (; protIt != psm->pPSM->proteinIds.end(); protIt++) {
-      if (proteinToIdxMap_.find(*protIt) != proteinToIdxMap_.end()) {
-        unsigned int proteinIdx = proteinToIdxMap_[*protIt];
-        if (seenProteinIdxs.find(proteinIdx) == seenProteinIdxs.end()) {
-          seenProteinIdxs.insert(proteinIdx);
-        }
+      if (internedIdToIdx_[*protIt] != kNoProteinIdx) {
+        seenProteinIdxs.insert(internedIdToIdx_[*protIt]);
       }
     }
     
@@ -374,10 +390,11 @@ void ProteinProbEstimator::addSpectralCounts(Scores& peptideScores) {
 /** Used by XMLInterface to read in the proteins with its sequence and store them for the Mayu method **/
 void ProteinProbEstimator::addProteinDb(bool isDecoy, std::string name, 
                                         std::string sequence, double length) {
+  SequenceFingerprint fingerprint = ProteinFDRestimator::fingerprintSequence(sequence);
   if (isDecoy)
-    decoyProteins_.insert(std::make_pair(name,std::make_pair(sequence,length)));
+    decoyProteins_.insert(std::make_pair(name,std::make_pair(fingerprint,length)));
   else
-    targetProteins_.insert(std::make_pair(name,std::make_pair(sequence,length)));
+    targetProteins_.insert(std::make_pair(name,std::make_pair(fingerprint,length)));
 }
 
 unsigned ProteinProbEstimator::countTargets(
@@ -223,13 +223,16 @@ class ProteinProbEstimator {
   /** contains all the protein names for target and decoy set respectively **/
   std::set<string> truePosSet_, falsePosSet_;
   
-  /** map from protein name to its sequence and its sequence length, used for Mayu method **/
-  std::map<std::string,std::pair<std::string,double> > targetProteins_;
-  std::map<std::string,std::pair<std::string,double> > decoyProteins_;
+  /** map from protein name to its sequence fingerprint and its sequence length, used for Mayu method **/
+  std::map<std::string,std::pair<SequenceFingerprint,double> > targetProteins_;
+  std::map<std::string,std::pair<SequenceFingerprint,double> > decoyProteins_;
   
   /** vector of protein scores **/
   std::vector<ProteinScoreHolder> proteins_;
   std::map<std::string, size_t> proteinToIdxMap_;
+  /** index into proteins_ for each interned protein id of the PSMs **/
+  std::vector<size_t> internedIdToIdx_;
+  static const size_t kNoProteinIdx = static_cast<size_t>(-1);
   
   /** protein groups are either present or absent and cannot be partially present **/
   bool trivialGrouping_;
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+
+#include "RetentionFeatureCache.h"
+
+RetentionFeatureCache::Entry& RetentionFeatureCache::getEntry(
+    const std::string& peptide, size_t numFeatures, bool& isNew) {
+  if (numFeatures != numFeatures_) {
+    clear();
+    numFeatures_ = numFeatures;
+  }
+  unsigned int id = peptides_.intern(peptide);
+  isNew = (id == entries_.size());
+  if (isNew) {
+    Entry entry;
+    entry.features = allocateRow();
+    entry.isoElectricPoint = 0.0;
+    entries_.push_back(entry);
+  }
+  return entries_[id];
+}
+
+double* RetentionFeatureCache::allocateRow() {
+  if (blocks_.empty() || numRowsInLastBlock_ == kRowsPerBlock) {
+    blocks_.push_back(new double[kRowsPerBlock * numFeatures_]());
+    numRowsInLastBlock_ = 0;
+  }
+  return blocks_.back() + (numRowsInLastBlock_++) * numFeatures_;
+}
+
+void RetentionFeatureCache::fillRows(std::vector<double*>& rows) const {
+  std::vector<Entry>::const_iterator it = entries_.begin();
+  for ( ; it != entries_.end(); ++it) {
+    rows.push_back(it->features);
+  }
+}
+
+void RetentionFeatureCache::clear() {
+  peptides_.clear();
+  entries_.clear();
+  std::vector<double*>::iterator blockIt = blocks_.begin();
+  for ( ; blockIt != blocks_.end(); ++blockIt) {
+    delete[] *blockIt;
+  }
+  blocks_.clear();
+  numRowsInLastBlock_ = 0;
+}
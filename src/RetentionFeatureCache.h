@@ -0,0 +1,66 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#ifndef RETENTION_FEATURE_CACHE_H_
+#define RETENTION_FEATURE_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "StringInterner.h"
+
+/*
+* RetentionFeatureCache keeps one retention feature row and iso-electric
+* point per PTM-free peptide sequence, so that PSMs of the same peptide
+* share them instead of each computing and storing their own copy.
+*
+* The peptides are numbered by a StringInterner, which indexes the entries.
+* The rows are allocated from blocks of kRowsPerBlock rows that are never
+* moved, so pointers to them stay valid until clear() is called. The cache
+* is not thread safe.
+*/
+class RetentionFeatureCache {
+ public:
+  struct Entry {
+    double* features;
+    double isoElectricPoint;
+  };
+  
+  RetentionFeatureCache() : numFeatures_(0), numRowsInLastBlock_(0) {}
+  ~RetentionFeatureCache() { clear(); }
+  
+  // returns the entry of the peptide, valid until the next call; if isNew
+  // is set, the entry was just created with a zero initialized row, which
+  // the caller has to fill in
+  Entry& getEntry(const std::string& peptide, size_t numFeatures, 
+                  bool& isNew);
+  // appends each cached row once, e.g. for normalizing the rows in place
+  void fillRows(std::vector<double*>& rows) const;
+  inline size_t size() const { return entries_.size(); }
+  void clear();
+  
+ protected:
+  static const size_t kRowsPerBlock = 4096;
+  
+  size_t numFeatures_, numRowsInLastBlock_;
+  std::vector<double*> blocks_;
+  StringInterner peptides_;
+  std::vector<Entry> entries_; // indexed by the id of the peptide
+  
+  double* allocateRow();
+};
+
+#endif /* RETENTION_FEATURE_CACHE_H_ */
@@ -28,6 +28,7 @@
 #include <string>
 #include <cmath>
 #include <memory>
+#include <functional>
 
 #include "DataSet.h"
 #include "Normalizer.h"
@@ -37,6 +38,7 @@
 #include "PosteriorEstimator.h"
 #include "ssl.h"
 #include "MassHandler.h"
+#include "LinearScorer.h"
 
 #ifdef CRUX
 #include "app/PercolatorAdapter.h"
@@ -106,9 +108,10 @@ void ScoreHolder::printPSM(ostream& os, bool printDecoys, bool printExpMass) {
       os << "      <peptide_seq n=\"" << n << "\" c=\"" << c << "\" seq=\"" << centpep << "\"/>" << endl;
     }
     
-    std::vector<std::string>::const_iterator pidIt = pPSM->proteinIds.begin();
+    std::vector<unsigned int>::const_iterator pidIt = pPSM->proteinIds.begin();
     for ( ; pidIt != pPSM->proteinIds.end() ; ++pidIt) {
-      os << "      <protein_id>" << getRidOfUnprintablesAndUnicode(*pidIt) << "</protein_id>" << endl;
+      os << "      <protein_id>" << getRidOfUnprintablesAndUnicode(
+          PSMDescription::getProteinIdString(*pidIt)) << "</protein_id>" << endl;
     }
     
     os << "      <p_value>" << scientific << p << "</p_value>" <<endl;
@@ -136,9 +139,10 @@ void ScoreHolder::printPeptide(ostream& os, bool printDecoys, bool printExpMass,
     }
     os << "      <calc_mass>" << fixed << setprecision (3)  << pPSM->calcMass << "</calc_mass>" << endl;
     
-    std::vector<std::string>::const_iterator pidIt = pPSM->proteinIds.begin();
+    std::vector<unsigned int>::const_iterator pidIt = pPSM->proteinIds.begin();
     for ( ; pidIt != pPSM->proteinIds.end() ; ++pidIt) {
-      os << "      <protein_id>" << getRidOfUnprintablesAndUnicode(*pidIt) << "</protein_id>" << endl;
+      os << "      <protein_id>" << getRidOfUnprintablesAndUnicode(
+          PSMDescription::getProteinIdString(*pidIt)) << "</protein_id>" << endl;
     }
     
     os << "      <p_value>" << scientific << p << "</p_value>" <<endl;
@@ -154,22 +158,57 @@ void ScoreHolder::printPeptide(ostream& os, bool printDecoys, bool printExpMass,
   }
 }
 
+/**
+ * Merges the test sets of the cross validation folds into this object. Each
+ * fold is sorted and calibrated in place. The buffer of the largest fold is 
+ * then taken over, the other folds are appended and released one at a time 
+ * and each appended run is merged in place with the sorted part before it.
+ */
 void Scores::merge(std::vector<Scores>& sv, double fdr, bool skipNormalizeScores) {
-  scores_.clear();
+  reset();
+  size_t totalSize = 0;
+  std::vector<Scores>::iterator largest = sv.end();
   for (std::vector<Scores>::iterator a = sv.begin(); a != sv.end(); a++) {
     sort(a->begin(), a->end(), greater<ScoreHolder> ());
     a->checkSeparationAndSetPi0();
     a->calcQ(fdr);
     if (!skipNormalizeScores) {
       a->normalizeScores(fdr);
+      // the calibration is monotone, but rounding can create ties that the
+      // tie breaking of the ordering resolves differently
+      if (adjacent_find(a->begin(), a->end(), less<ScoreHolder> ()) != a->end()) {
+        sort(a->begin(), a->end(), greater<ScoreHolder> ());
+      }
     }
-    copy(a->begin(), a->end(), back_inserter(scores_));
+    totalSize += a->size();
+    if (largest == sv.end() || a->size() > largest->size()) largest = a;
   }
-  postMergeStep();
+  if (largest == sv.end()) {
+    setTargetDecoySizes();
+    return;
+  }
+  
+  scores_.swap(largest->scores_);
+  largest->releaseScores();
+  scores_.reserve(totalSize);
+  for (std::vector<Scores>::iterator a = sv.begin(); a != sv.end(); a++) {
+    if (a == largest) continue;
+    size_t sortedSize = scores_.size();
+    scores_.insert(scores_.end(), a->begin(), a->end());
+    a->releaseScores();
+    std::inplace_merge(scores_.begin(), scores_.begin() + sortedSize, 
+                       scores_.end(), greater<ScoreHolder> ());
+  }
+  
+  setTargetDecoySizes();
 }
 
 void Scores::postMergeStep() {
   sort(scores_.begin(), scores_.end(), greater<ScoreHolder> ());
+  setTargetDecoySizes();
+}
+
+void Scores::setTargetDecoySizes() {
   totalNumberOfDecoys_ = count_if(scores_.begin(),
       scores_.end(),
       mem_fun_ref(&ScoreHolder::isDecoy));
@@ -190,34 +229,56 @@ void Scores::printRetentionTime(ostream& outs, double fdr) {
   }
 }
 
-double Scores::calcScore(const double* feat, const std::vector<double>& w) const {
-  register int ix = FeatureNames::getNumFeatures();
-  register double score = w[ix];
-  for (; ix--;) {
-    score += feat[ix] * w[ix];
-  }
-  return score;
+double Scores::calcScore(const FeatureValue* feat, 
+    const std::vector<double>& w) const {
+  return LinearScorer::score(feat, &w[0], FeatureNames::getNumFeatures());
 }
 
 void Scores::scoreAndAddPSM(ScoreHolder& sh, 
     const std::vector<double>& rawWeights, FeatureMemoryPool& featurePool) {
-  const unsigned int numFeatures = FeatureNames::getNumFeatures();
+  calcDOCFeatures(sh);
+  sh.score = calcScore(sh.pPSM->features, rawWeights);
+  addScoredPSM(sh, featurePool);
+}
+
+/**
+ * Batch version of scoreAndAddPSM, the feature rows of all PSMs are scored
+ * together with the blocked scoring kernel
+ */
+void Scores::scoreAndAddPSMs(std::vector<ScoreHolder>& shs, 
+    const std::vector<double>& rawWeights, FeatureMemoryPool& featurePool) {
+  std::vector<const FeatureValue*> rows(shs.size());
+  for (size_t i = 0; i < shs.size(); ++i) {
+    calcDOCFeatures(shs[i]);
+    rows[i] = shs[i].pPSM->features;
+  }
+  std::vector<double> rowScores(shs.size());
+  scoreFeatureRows(rows, rawWeights, rowScores);
+  for (size_t i = 0; i < shs.size(); ++i) {
+    shs[i].score = rowScores[i];
+    addScoredPSM(shs[i], featurePool);
+  }
+}
+
+void Scores::calcDOCFeatures(ScoreHolder& sh) {
   if (DataSet::getCalcDoc()) {
+    const unsigned int numFeatures = FeatureNames::getNumFeatures();
     size_t numRTFeatures = RTModel::totalNumRTFeatures();
-    double* rtFeatures = new double[numRTFeatures]();
+    // the retention features are only needed to set the DOC features, so 
+    // one buffer is reused for all PSMs
+    rtFeatureBuffer_.assign(numRTFeatures, 0.0);
+    double* rtFeatures = &rtFeatureBuffer_[0];
+    sh.pPSM->setRetentionFeatures(rtFeatures);
     DescriptionOfCorrect::calcRegressionFeature(sh.pPSM);
     for (size_t i = 0; i < numRTFeatures; ++i) {
       rtFeatures[i] = Normalizer::getNormalizer()->normalize(rtFeatures[i], numFeatures + i);
     }
-    sh.pPSM->setRetentionFeatures(rtFeatures);
     doc_.setFeatures(sh.pPSM);
+    sh.pPSM->setRetentionFeatures(NULL);
   }
-  
-  for (unsigned int j = 0; j < numFeatures; j++) {
-    sh.score += sh.pPSM->features[j] * rawWeights[j];
-  }
-  sh.score += rawWeights[numFeatures];
-  
+}
+
+void Scores::addScoredPSM(ScoreHolder& sh, FeatureMemoryPool& featurePool) {
   featurePool.deallocate(sh.pPSM->features);
   sh.pPSM->deleteRetentionFeatures();
   
@@ -254,7 +315,7 @@ void Scores::print(int label, std::ostream& os) {
 }
 
 void Scores::fillFeatures(SetHandler& setHandler) {
-  scores_.clear();
+  reset();
   setHandler.fillFeatures(scores_,1);
   setHandler.fillFeatures(scores_,-1);
   totalNumberOfTargets_ = setHandler.getSizeFromLabel(1);
@@ -320,23 +381,20 @@ void Scores::createXvalSetsBySpectrum(std::vector<Scores>& train,
     ix -= remain[fold];
   }
 
-  // store possible spectra with relative scores_
-  multimap<unsigned int,ScoreHolder> spectraScores;
-  // populate spectraScores
-  std::vector<ScoreHolder>::iterator scoreIt = scores_.begin();
-  for ( ; scoreIt != scores_.end(); ++scoreIt) {
-    spectraScores.insert(std::make_pair(scoreIt->pPSM->scan, *scoreIt));
-  }
+  // order the scores_ by spectrum; the stable sort keeps the PSMs of a 
+  // spectrum in their original order, as a multimap on the scan would
+  std::vector<SpectrumKey> spectraKeys;
+  fillSpectrumKeys(spectraKeys);
+  std::stable_sort(spectraKeys.begin(), spectraKeys.end(), OrderKeyScan());
 
   // put scores into the folds; choose a fold (at random) and change it only
   // when scores from a new spectra are encountered
-  // note: this works because multimap is an ordered container!
-  unsigned int previousSpectrum = spectraScores.begin()->first;
+  unsigned int previousSpectrum = spectraKeys.begin()->scan;
   size_t randIndex = PseudoRandom::lcg_rand() % xval_fold;
-  for (multimap<unsigned int, ScoreHolder>::iterator it = spectraScores.begin(); 
-        it != spectraScores.end(); ++it) {
-    const unsigned int curScan = (*it).first;
-    const ScoreHolder sh = (*it).second;
+  for (std::vector<SpectrumKey>::const_iterator it = spectraKeys.begin(); 
+        it != spectraKeys.end(); ++it) {
+    const unsigned int curScan = it->scan;
+    const ScoreHolder& sh = scores_[it->idx];
     // if current score is from a different spectra than the one encountered in
     // the previous iteration, choose new fold
     
@@ -368,17 +426,52 @@ void Scores::createXvalSetsBySpectrum(std::vector<Scores>& train,
   }
   
   if (featurePool.isInitialized()) {
-    std::map<double*, double*> movedAddresses;
+    std::map<FeatureValue*, FeatureValue*> movedAddresses;
     size_t idx = 0;
     for (unsigned int i = 0; i < xval_fold; ++i) {
+      size_t firstRow = idx;
       bool isTarget = true;
       test[i].reorderFeatureRows(featurePool, isTarget, movedAddresses, idx);
       isTarget = false;
       test[i].reorderFeatureRows(featurePool, isTarget, movedAddresses, idx);
+      // the rows of the test set are now contiguous in the pool
+      test[i].setFeatureRows(featurePool, firstRow, idx - firstRow);
     }
   }
 }
 
+void Scores::fillSpectrumKeys(std::vector<SpectrumKey>& keys) const {
+  keys.resize(scores_.size());
+  for (size_t ix = 0; ix < scores_.size(); ++ix) {
+    const ScoreHolder& sh = scores_[ix];
+    keys[ix].expMass = sh.pPSM->expMass;
+    keys[ix].score = sh.score;
+    keys[ix].scan = sh.pPSM->scan;
+    keys[ix].idx = static_cast<unsigned int>(ix);
+    keys[ix].label = sh.label;
+  }
+}
+
+/**
+ * Sorts the scores_ by sorting an array of SpectrumKeys and then moving the 
+ * ScoreHolders into place; ScoreHolders that tie on every field compared by
+ * keyOrder end up in an unspecified order
+ */
+template <class KeyOrder>
+void Scores::sortBySpectrumKeys(KeyOrder keyOrder) {
+  std::vector<SpectrumKey> keys;
+  fillSpectrumKeys(keys);
+  std::sort(keys.begin(), keys.end(), keyOrder);
+  
+  std::vector<ScoreHolder> sortedScores;
+  sortedScores.reserve(scores_.size());
+  std::vector<SpectrumKey>::const_iterator keyIt = keys.begin();
+  for ( ; keyIt != keys.end(); ++keyIt) {
+    sortedScores.push_back(scores_[keyIt->idx]);
+  }
+  scores_.swap(sortedScores);
+}
+
 void Scores::recalculateSizes() {
   totalNumberOfTargets_ = 0;
   totalNumberOfDecoys_ = 0;
@@ -394,13 +487,14 @@ void Scores::recalculateSizes() {
 }
 
 void Scores::reorderFeatureRows(FeatureMemoryPool& featurePool, 
-    bool isTarget, std::map<double*, double*>& movedAddresses, size_t& idx) {
+    bool isTarget, std::map<FeatureValue*, FeatureValue*>& movedAddresses, 
+    size_t& idx) {
   size_t numFeatures = FeatureNames::getNumFeatures();
   std::vector<ScoreHolder>::const_iterator scoreIt = scores_.begin();
   for ( ; scoreIt != scores_.end(); ++scoreIt) {
     if (scoreIt->isTarget() == isTarget) {
-      double* newAddress = featurePool.addressFromIdx(idx++);
-      double* oldAddress = scoreIt->pPSM->features;
+      FeatureValue* newAddress = featurePool.addressFromIdx(idx++);
+      FeatureValue* oldAddress = scoreIt->pPSM->features;
       while (movedAddresses.find(oldAddress) != movedAddresses.end()) {
         oldAddress = movedAddresses[oldAddress];
       }
@@ -413,6 +507,63 @@ void Scores::reorderFeatureRows(FeatureMemoryPool& featurePool,
   }
 }
 
+/**
+ * Scores the contiguous feature rows of this set by walking the blocks of the
+ * feature pool, and writes the scores back to the PSMs by their row index
+ * @param w normal vector used for SVM cost
+ */
+void Scores::scoreFeatureRows(const std::vector<double>& w) {
+  const size_t numFeatures = FeatureNames::getNumFeatures();
+  const size_t rowLength = featurePool_->getNumFeatures();
+  const size_t rowsPerBlock = featurePool_->getNumRowsPerBlock();
+  const size_t endRow = firstFeatureRow_ + numFeatureRows_;
+  const int numScores = static_cast<int>(scores_.size());
+  if (numScores == 0) return;
+  
+  std::vector<double> rowScores(numFeatureRows_);
+  const size_t firstBlock = firstFeatureRow_ / rowsPerBlock;
+  const int numBlocks = static_cast<int>((endRow - 1) / rowsPerBlock - firstBlock + 1);
+  bool parallel = numFeatureRows_ >= LinearScorer::kMinParallelRows;
+#pragma omp parallel for schedule(static) if (parallel)
+  for (int b = 0; b < numBlocks; ++b) {
+    size_t block = firstBlock + b;
+    size_t blockStartRow = block * rowsPerBlock;
+    size_t beginRow = std::max(firstFeatureRow_, blockStartRow);
+    size_t endBlockRow = std::min(endRow, blockStartRow + rowsPerBlock);
+    LinearScorer::scoreRows(
+        featurePool_->getBlock(block) + (beginRow - blockStartRow) * rowLength,
+        endBlockRow - beginRow, rowLength, &w[0], numFeatures, 
+        &rowScores[beginRow - firstFeatureRow_]);
+  }
+  
+#pragma omp parallel for schedule(static) if (parallel)
+  for (int i = 0; i < numScores; ++i) {
+    size_t row = featurePool_->indexFromAddress(scores_[i].pPSM->features);
+    scores_[i].score = rowScores[row - firstFeatureRow_];
+  }
+}
+
+/**
+ * Scores feature rows that are not contiguous in memory, in chunks of rows
+ * @param rows pointers to the feature rows
+ * @param w normal vector used for SVM cost
+ * @param rowScores output vector with the score of each row
+ */
+void Scores::scoreFeatureRows(const std::vector<const FeatureValue*>& rows, 
+    const std::vector<double>& w, std::vector<double>& rowScores) {
+  const size_t numFeatures = FeatureNames::getNumFeatures();
+  const size_t kChunkSize = 1024;
+  const int numChunks = static_cast<int>((rows.size() + kChunkSize - 1) / kChunkSize);
+  bool parallel = rows.size() >= LinearScorer::kMinParallelRows;
+#pragma omp parallel for schedule(static) if (parallel)
+  for (int c = 0; c < numChunks; ++c) {
+    size_t begin = c * kChunkSize;
+    size_t numRows = std::min(kChunkSize, rows.size() - begin);
+    LinearScorer::scoreRows(&rows[begin], numRows, &w[0], numFeatures, 
+                            &rowScores[begin]);
+  }
+}
+
 // sets q=fdr to 0 and the median decoy to -1, linear transform the rest to fit
 void Scores::normalizeScores(double fdr) {  
   unsigned int medianIndex = std::max(0u,totalNumberOfDecoys_/2u),decoys=0u;
@@ -453,9 +604,18 @@ void Scores::normalizeScores(double fdr) {
  */
 int Scores::calcScores(std::vector<double>& w, double fdr, bool skipDecoysPlusOne) {
   unsigned int ix;
-  std::vector<ScoreHolder>::iterator scoreIt = scores_.begin();
-  for ( ; scoreIt != scores_.end(); ++scoreIt) {
-    scoreIt->score = calcScore(scoreIt->pPSM->features, w);
+  if (featurePool_ != NULL && numFeatureRows_ == scores_.size()) {
+    scoreFeatureRows(w);
+  } else {
+    std::vector<const FeatureValue*> rows(scores_.size());
+    for (ix = 0; ix < scores_.size(); ++ix) {
+      rows[ix] = scores_[ix].pPSM->features;
+    }
+    std::vector<double> rowScores(scores_.size());
+    scoreFeatureRows(rows, w, rowScores);
+    for (ix = 0; ix < scores_.size(); ++ix) {
+      scores_[ix].score = rowScores[ix];
+    }
   }
   sort(scores_.begin(), scores_.end(), greater<ScoreHolder> ());
   if (VERB > 3) {
@@ -529,7 +689,7 @@ void Scores::generatePositiveTrainingSet(AlgIn& data, const double fdr,
   
   std::vector<ScoreHolder>::iterator lastUniqueIt = scores_.end();
   if (trainBestPositive) {
-    std::sort(scores_.begin(), scores_.end(), OrderScanLabel());
+    sortBySpectrumKeys(OrderKeyScanLabel());
     lastUniqueIt = std::unique(scores_.begin(), scores_.end(), UniqueScanLabel());
     std::sort(scores_.begin(), lastUniqueIt, greater<ScoreHolder> ());
   }
@@ -595,7 +755,7 @@ void Scores::weedOutRedundant(std::map<std::string, unsigned int>& peptideSpecCo
  */
 void Scores::weedOutRedundantTDC() {
   // order the scores (based on spectra id and score)
-  std::sort(scores_.begin(), scores_.end(), OrderScanMassCharge());  
+  sortBySpectrumKeys(OrderKeyScanMassCharge());
   scores_.erase(std::unique(scores_.begin(), scores_.end(), UniqueScanMassCharge()), scores_.end());
   
   /* does not actually release memory because of memory fragmentation
@@ -625,7 +785,7 @@ void Scores::weedOutRedundantTDC() {
  */
 void Scores::weedOutRedundantMixMax() {
   // order the scores (based on spectra id and score)
-  std::sort(scores_.begin(), scores_.end(), OrderScanMassLabelCharge());  
+  sortBySpectrumKeys(OrderKeyScanMassLabelCharge());
   scores_.erase(std::unique(scores_.begin(), scores_.end(), UniqueScanMassLabelCharge()), scores_.end());
   
   postMergeStep();
@@ -643,10 +803,44 @@ void Scores::recalculateDescriptionOfCorrect(const double fdr) {
 }
 
 void Scores::setDOCFeatures(Normalizer* pNorm) {
+  std::vector<PSMDescription*> psms;
+  psms.reserve(scores_.size());
   std::vector<ScoreHolder>::const_iterator scoreIt = scores_.begin();
   for ( ; scoreIt != scores_.end(); ++scoreIt) {
-    doc_.setFeaturesNormalized(scoreIt->pPSM, pNorm);
+    psms.push_back(scoreIt->pPSM);
+  }
+  doc_.setFeaturesNormalized(psms, pNorm);
+}
+
+/**
+ * Counts the targets with q < fdr if PSMs are ranked by a single feature,
+ * walking the sorted target and decoy feature values in the order given by 
+ * comesFirst. Since the q-value is the running minimum of the FDR from the 
+ * back, these are the targets ranked at or above the last tie group with 
+ * an FDR below the threshold. Gives the same count as calcQ without the 
+ * mix-max correction.
+ */
+template <class Iterator, class Compare>
+static int countPositivesInDirection(Iterator targetIt, Iterator targetEnd, 
+    Iterator decoyIt, Iterator decoyEnd, Compare comesFirst, double pi0, 
+    double fdr, bool skipDecoysPlusOne) {
+  int numTargets = 0, numDecoys = (skipDecoysPlusOne ? 0 : 1), numPos = 0;
+  while (targetIt != targetEnd || decoyIt != decoyEnd) {
+    double value = (targetIt != targetEnd && 
+        (decoyIt == decoyEnd || !comesFirst(*decoyIt, *targetIt))) ? 
+        *targetIt : *decoyIt;
+    for ( ; targetIt != targetEnd && *targetIt == value; ++targetIt) {
+      ++numTargets;
+    }
+    for ( ; decoyIt != decoyEnd && *decoyIt == value; ++decoyIt) {
+      ++numDecoys;
+    }
+    double groupFdr = numDecoys * pi0 / (double)(std::max)(1, numTargets);
+    if ((std::min)(groupFdr, 1.0) < fdr) {
+      numPos = numTargets;
+    }
   }
+  return numPos;
 }
 
 int Scores::getInitDirection(const double initialSelectionFdr, std::vector<double>& direction) {
@@ -658,21 +852,56 @@ int Scores::getInitDirection(const double initialSelectionFdr, std::vector<doubl
   // is too restrictive for small datasets
   bool skipDecoysPlusOne = true; 
   
-  for (unsigned int featNo = 0; featNo < FeatureNames::getNumFeatures(); featNo++) {
-    for (std::vector<ScoreHolder>::iterator scoreIt = scores_.begin(); 
-         scoreIt != scores_.end(); ++scoreIt) {
-      scoreIt->score = scoreIt->pPSM->features[featNo];
+  const int numFeatures = static_cast<int>(FeatureNames::getNumFeatures());
+  // number of positives if lower (index 0) or higher (index 1) values of 
+  // the feature are better
+  std::vector<int> positives(2 * numFeatures, 0);
+  if (pi0_ < 1.0) {
+    // the mix-max correction needs the full q-value calculation
+    for (int featNo = 0; featNo < numFeatures; featNo++) {
+      for (std::vector<ScoreHolder>::iterator scoreIt = scores_.begin(); 
+           scoreIt != scores_.end(); ++scoreIt) {
+        scoreIt->score = scoreIt->pPSM->features[featNo];
+      }
+      sort(scores_.begin(), scores_.end());
+      positives[2 * featNo] = calcQ(initialSelectionFdr, skipDecoysPlusOne);
+      reverse(scores_.begin(), scores_.end());
+      positives[2 * featNo + 1] = calcQ(initialSelectionFdr, skipDecoysPlusOne);
     }
-    sort(scores_.begin(), scores_.end());
-    // check once in forward direction (i = 0, higher scores are better) and 
-    // once in backward direction (i = 1, lower scores are better)
-    for (int i = 0; i < 2; i++) {
-      if (i == 1) {
-        reverse(scores_.begin(), scores_.end());
+  } else {
+    // one sort per feature serves both directions
+  #pragma omp parallel for schedule(dynamic, 1)
+    for (int featNo = 0; featNo < numFeatures; featNo++) {
+      std::vector<double> targetValues, decoyValues;
+      targetValues.reserve(totalNumberOfTargets_);
+      decoyValues.reserve(totalNumberOfDecoys_);
+      std::vector<ScoreHolder>::const_iterator scoreIt = scores_.begin();
+      for ( ; scoreIt != scores_.end(); ++scoreIt) {
+        if (scoreIt->label > 0) {
+          targetValues.push_back(scoreIt->pPSM->features[featNo]);
+        } else {
+          decoyValues.push_back(scoreIt->pPSM->features[featNo]);
+        }
       }
-      int positives = calcQ(initialSelectionFdr, skipDecoysPlusOne);
-      if (positives > bestPositives) {
-        bestPositives = positives;
+      sort(targetValues.begin(), targetValues.end());
+      sort(decoyValues.begin(), decoyValues.end());
+      positives[2 * featNo] = countPositivesInDirection(
+          targetValues.begin(), targetValues.end(), 
+          decoyValues.begin(), decoyValues.end(), std::less<double>(), 
+          pi0_, initialSelectionFdr, skipDecoysPlusOne);
+      positives[2 * featNo + 1] = countPositivesInDirection(
+          targetValues.rbegin(), targetValues.rend(), 
+          decoyValues.rbegin(), decoyValues.rend(), std::greater<double>(), 
+          pi0_, initialSelectionFdr, skipDecoysPlusOne);
+    }
+  }
+  
+  // same order of comparisons as checking each feature once in forward 
+  // direction (lower scores are better) and once in backward direction 
+  for (int featNo = 0; featNo < numFeatures; featNo++) {
+    for (int i = 0; i < 2; i++) {
+      if (positives[2 * featNo + i] > bestPositives) {
+        bestPositives = positives[2 * featNo + i];
         bestFeature = featNo;
         lowBest = (i == 0);
       }
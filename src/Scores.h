@@ -56,7 +56,6 @@ class ScoreHolder {
   ScoreHolder() : score(0.0), q(0.0), pep(0.0), p(0.0), label(0), pPSM(NULL) {}
   ScoreHolder(const double s, const int l, PSMDescription* psm = NULL) :
     score(s), q(0.0), pep(0.0), p(0.0), label(l), pPSM(psm) {}
-  virtual ~ScoreHolder() {}
   
   std::pair<double, bool> toPair() const { 
     return pair<double, bool> (score, label > 0); 
@@ -94,49 +93,69 @@ struct lexicOrderProb : public binary_function<ScoreHolder, ScoreHolder, bool> {
   }
 };
 
-struct OrderScanMassCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
+
+struct UniqueScanMassCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
   bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return ( (__x.pPSM->scan < __y.pPSM->scan ) 
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass < __y.pPSM->expMass) )
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass == __y.pPSM->expMass) 
-       && (__x.score > __y.score) ) );
+    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass == __y.pPSM->expMass);
   }
 };
 
-struct OrderScanMassLabelCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
+struct UniqueScanMassLabelCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
   bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return ( (__x.pPSM->scan < __y.pPSM->scan ) 
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass < __y.pPSM->expMass) )
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass == __y.pPSM->expMass) 
-       && (__x.label > __y.label) )
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass == __y.pPSM->expMass) 
-       && (__x.label == __y.label) && (__x.score > __y.score) ) );
+    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.label == __y.label) && (__x.pPSM->expMass == __y.pPSM->expMass);
   }
 };
 
-struct OrderScanLabel : public binary_function<ScoreHolder, ScoreHolder, bool> {
+struct UniqueScanLabel : public binary_function<ScoreHolder, ScoreHolder, bool> {
   bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return ( (__x.pPSM->scan < __y.pPSM->scan ) 
-    || ( (__x.pPSM->scan == __y.pPSM->scan) && (__x.label > __y.label) ) );
+    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.label == __y.label);
   }
 };
 
+/*
+* SpectrumKey is a compact copy of the fields of a ScoreHolder that the 
+* spectrum based orderings compare, with idx its position in the Scores 
+* object. The OrderKey comparators below sort these keys by scan, mass, 
+* label and score without dereferencing pPSM on every comparison. The sort
+* is not stable, so the order of keys that tie on every compared field is 
+* unspecified.
+*/
+struct SpectrumKey {
+  double expMass, score;
+  unsigned int scan, idx;
+  int label;
+};
 
-struct UniqueScanMassCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
-  bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.pPSM->expMass == __y.pPSM->expMass);
+struct OrderKeyScan : public binary_function<SpectrumKey, SpectrumKey, bool> {
+  bool operator()(const SpectrumKey& __x, const SpectrumKey& __y) const {
+    return (__x.scan < __y.scan);
   }
 };
 
-struct UniqueScanMassLabelCharge : public binary_function<ScoreHolder, ScoreHolder, bool> {
-  bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.label == __y.label) && (__x.pPSM->expMass == __y.pPSM->expMass);
+struct OrderKeyScanMassCharge : public binary_function<SpectrumKey, SpectrumKey, bool> {
+  bool operator()(const SpectrumKey& __x, const SpectrumKey& __y) const {
+    return ( (__x.scan < __y.scan ) 
+    || ( (__x.scan == __y.scan) && (__x.expMass < __y.expMass) )
+    || ( (__x.scan == __y.scan) && (__x.expMass == __y.expMass) 
+       && (__x.score > __y.score) ) );
   }
 };
 
-struct UniqueScanLabel : public binary_function<ScoreHolder, ScoreHolder, bool> {
-  bool operator()(const ScoreHolder& __x, const ScoreHolder& __y) const {
-    return (__x.pPSM->scan == __y.pPSM->scan) && (__x.label == __y.label);
+struct OrderKeyScanMassLabelCharge : public binary_function<SpectrumKey, SpectrumKey, bool> {
+  bool operator()(const SpectrumKey& __x, const SpectrumKey& __y) const {
+    return ( (__x.scan < __y.scan ) 
+    || ( (__x.scan == __y.scan) && (__x.expMass < __y.expMass) )
+    || ( (__x.scan == __y.scan) && (__x.expMass == __y.expMass) 
+       && (__x.label > __y.label) )
+    || ( (__x.scan == __y.scan) && (__x.expMass == __y.expMass) 
+       && (__x.label == __y.label) && (__x.score > __y.score) ) );
+  }
+};
+
+struct OrderKeyScanLabel : public binary_function<SpectrumKey, SpectrumKey, bool> {
+  bool operator()(const SpectrumKey& __x, const SpectrumKey& __y) const {
+    return ( (__x.scan < __y.scan ) 
+    || ( (__x.scan == __y.scan) && (__x.label > __y.label) ) );
   }
 };
 
@@ -170,7 +189,8 @@ class Scores {
  public:
   Scores(bool usePi0) : usePi0_(usePi0), pi0_(1.0), 
     targetDecoySizeRatio_(1.0), totalNumberOfDecoys_(0),
-    totalNumberOfTargets_(0), decoyPtr_(NULL), targetPtr_(NULL) {}
+    totalNumberOfTargets_(0), decoyPtr_(NULL), targetPtr_(NULL),
+    featurePool_(NULL), firstFeatureRow_(0), numFeatureRows_(0) {}
   ~Scores() {}
   void merge(vector<Scores>& sv, double fdr, bool skipNormalizeScores);
   void postMergeStep();
@@ -178,9 +198,13 @@ class Scores {
   std::vector<ScoreHolder>::iterator begin() { return scores_.begin(); }
   std::vector<ScoreHolder>::iterator end() { return scores_.end(); }
   
-  double calcScore(const double* features, const std::vector<double>& w) const;
+  double calcScore(const FeatureValue* features, 
+                   const std::vector<double>& w) const;
   void scoreAndAddPSM(ScoreHolder& sh, const std::vector<double>& rawWeights,
                       FeatureMemoryPool& featurePool);
+  void scoreAndAddPSMs(std::vector<ScoreHolder>& shs, 
+                       const std::vector<double>& rawWeights,
+                       FeatureMemoryPool& featurePool);
   int calcScores(vector<double>& w, double fdr, bool skipDecoysPlusOne = false);
   int calcQ(double fdr, bool skipDecoysPlusOne = false);
   void recalculateDescriptionOfCorrect(const double fdr);
@@ -227,6 +251,16 @@ class Scores {
   
   inline void addScoreHolder(const ScoreHolder& sh) {
     scores_.push_back(sh);
+    featurePool_ = NULL;
+  }
+  
+  // tells calcScores that the feature rows of all PSMs in this set are the 
+  // rows firstRow, ..., firstRow + numRows - 1 of featurePool
+  inline void setFeatureRows(FeatureMemoryPool& featurePool, size_t firstRow,
+                             size_t numRows) {
+    featurePool_ = &featurePool;
+    firstFeatureRow_ = firstRow;
+    numFeatureRows_ = numRows;
   }
   
   std::vector<PSMDescription*>& getPsms(PSMDescription* pPSM) {
@@ -235,9 +269,15 @@ class Scores {
   
   void reset() { 
     scores_.clear(); 
+    featurePool_ = NULL;
     totalNumberOfTargets_ = 0;
     totalNumberOfDecoys_ = 0;
   }
+  // as reset(), but also frees the memory of the score vector
+  void releaseScores() {
+    reset();
+    std::vector<ScoreHolder>().swap(scores_);
+  }
   
  protected:
   bool usePi0_;
@@ -253,10 +293,25 @@ class Scores {
   double* decoyPtr_;
   double* targetPtr_;
   
+  FeatureMemoryPool* featurePool_;
+  size_t firstFeatureRow_, numFeatureRows_;
+  std::vector<double> rtFeatureBuffer_;
+  
   void reorderFeatureRows(FeatureMemoryPool& featurePool, bool isTarget,
-    std::map<double*, double*>& movedAddresses, size_t& idx);
+    std::map<FeatureValue*, FeatureValue*>& movedAddresses, size_t& idx);
+  void calcDOCFeatures(ScoreHolder& sh);
+  void addScoredPSM(ScoreHolder& sh, FeatureMemoryPool& featurePool);
+  void scoreFeatureRows(const std::vector<double>& w);
+  void scoreFeatureRows(const std::vector<const FeatureValue*>& rows, 
+                        const std::vector<double>& w, 
+                        std::vector<double>& rowScores);
   void getScoreLabelPairs(std::vector<pair<double, bool> >& combined);
   void checkSeparationAndSetPi0();
+  void setTargetDecoySizes();
+  
+  void fillSpectrumKeys(std::vector<SpectrumKey>& keys) const;
+  template <class KeyOrder>
+  void sortBySpectrumKeys(KeyOrder keyOrder);
 };
 
 #endif /*SCORES_H_*/
@@ -17,7 +17,8 @@
 
 #include "SetHandler.h"
 
-SetHandler::SetHandler(unsigned int maxPSMs) : maxPSMs_(maxPSMs) {}
+SetHandler::SetHandler(unsigned int maxPSMs) : maxPSMs_(maxPSMs), 
+    collectFeatureStatistics_(false), hasFeatureStatistics_(false) {}
 
 SetHandler::~SetHandler() {
   reset();
@@ -31,6 +32,8 @@ void SetHandler::reset() {
     subsets_[ix] = NULL;
   }
   subsets_.clear();
+  DescriptionOfCorrect::getRetentionFeatureCache().clear();
+  hasFeatureStatistics_ = false;
   DataSet::resetFeatureNames();
 }
 /**
@@ -60,22 +63,38 @@ void SetHandler::fillFeatures(vector<ScoreHolder> &scores, int label) {
 }
 
 void SetHandler::normalizeFeatures(Normalizer*& pNorm) {
-  std::vector<double*> featuresV, rtFeaturesV;
+  std::vector<FeatureValue*> featuresV;
+  std::vector<double*> rtFeaturesV;
   for (unsigned int ix = 0; ix < subsets_.size(); ++ix) {
-    subsets_[ix]->fillFeatures(featuresV);
-    subsets_[ix]->fillRtFeatures(rtFeaturesV);
+    if (!hasFeatureStatistics_) {
+      subsets_[ix]->fillFeatures(featuresV);
+      subsets_[ix]->fillRtFeatures(rtFeaturesV);
+    }
   }
+  // PSMs of the same peptide share their retention features, so the
+  // statistics are taken over the PSMs, but each row is normalized once
+  std::vector<double*> uniqueRtFeaturesV;
+  DescriptionOfCorrect::getRetentionFeatureCache().fillRows(uniqueRtFeaturesV);
   pNorm = Normalizer::getNormalizer();
-
-  pNorm->setSet(featuresV,
-      rtFeaturesV,
-      FeatureNames::getNumFeatures(),
-      DataSet::getCalcDoc() ? RTModel::totalNumRTFeatures() : 0);
-  pNorm->normalizeSet(featuresV, rtFeaturesV);
+  
+  size_t numFeatures = FeatureNames::getNumFeatures();
+  size_t numRetentionFeatures = DataSet::getCalcDoc() ? 
+                                    RTModel::totalNumRTFeatures() : 0;
+  if (hasFeatureStatistics_) {
+    // statistics were collected during reading, all rows in the feature
+    // pool belong to a PSM and can be normalized block by block
+    pNorm->setStatistics(featureStats_, rtFeatureStats_, numFeatures, 
+                         numRetentionFeatures);
+    pNorm->normalizeSet(featurePool_, numFeatures);
+    pNorm->normalizeSet(uniqueRtFeaturesV, numFeatures, numRetentionFeatures);
+  } else {
+    pNorm->setSet(featuresV, rtFeaturesV, numFeatures, numRetentionFeatures);
+    pNorm->normalizeSet(featuresV, uniqueRtFeaturesV);
+  }
 }
 
 void SetHandler::normalizeDOCFeatures(Normalizer* pNorm) {
-  std::vector<double*> featuresDOC;
+  std::vector<FeatureValue*> featuresDOC;
   for (unsigned int ix = 0; ix < subsets_.size(); ++ix) {
     subsets_[ix]->fillDOCFeatures(featuresDOC);
   }
@@ -287,8 +306,21 @@ void SetHandler::readPSMs(istream& dataStream, std::string& psmLine,
     
     addQueueToSets(subsetPSMs, targetSet, decoySet);
   } else { // simply read all PSMs
+    // the rows are parsed in file order, as each one takes the next row of 
+    // the feature pool and the scan ids of the rows before it decide whether
+    // this is a concatenated search
     unsigned int targetIdx = 0u, decoyIdx = 0u;
     std::map<ScanId, bool> scanIdLookUp; // ScanId -> isDecoy
+    FeatureStatistics* featureStats = NULL;
+    FeatureStatistics* rtFeatureStats = NULL;
+    if (collectFeatureStatistics_) {
+      featureStats_.init(FeatureNames::getNumFeatures());
+      featureStats = &featureStats_;
+      if (DataSet::getCalcDoc()) {
+        rtFeatureStats_.init(RTModel::totalNumRTFeatures());
+        rtFeatureStats = &rtFeatureStats_;
+      }
+    }
     do {
       psmLine = rtrim(psmLine);
       int label = 0;
@@ -303,15 +335,18 @@ void SetHandler::readPSMs(istream& dataStream, std::string& psmLine,
       }
       
       if (label == 1) {
-        targetSet->readPsm(psmLine, lineNr, optionalFields, featurePool_);
+        targetSet->readPsm(psmLine, lineNr, optionalFields, featurePool_,
+                           featureStats, rtFeatureStats);
       } else if (label == -1) {
-        decoySet->readPsm(psmLine, lineNr, optionalFields, featurePool_);
+        decoySet->readPsm(psmLine, lineNr, optionalFields, featurePool_,
+                          featureStats, rtFeatureStats);
       } else {
         std::cerr << "Warning: the PSM on line " << lineNr
             << " has a label not in {1,-1} and will be ignored." << std::endl;
       }
       ++lineNr;
     } while (getline(dataStream, psmLine));
+    hasFeatureStatistics_ = collectFeatureStatistics_;
   }
   
   if (VERB > 1) {
@@ -518,6 +553,10 @@ void SetHandler::readAndScorePSMs(istream& dataStream, std::string& psmLine,
     std::vector<double>& rawWeights, Scores& allScores) {
   unsigned int lineNr = (hasInitialValueRow ? 3u : 2u);
   bool readProteins = true;
+  // PSMs are scored in batches, so that the scoring kernel can work on 
+  // several feature rows at once
+  std::vector<ScoreHolder> batch;
+  batch.reserve(kScoreBatchSize);
   do {
     if (lineNr % 1000000 == 0 && VERB > 1) {
       std::cerr << "Processing line " << lineNr << std::endl;
@@ -525,9 +564,14 @@ void SetHandler::readAndScorePSMs(istream& dataStream, std::string& psmLine,
     psmLine = rtrim(psmLine);
     ScoreHolder sh;
     sh.label = DataSet::readPsm(psmLine, lineNr, optionalFields, readProteins, sh.pPSM, featurePool_);
-    allScores.scoreAndAddPSM(sh, rawWeights, featurePool_);
+    batch.push_back(sh);
+    if (batch.size() == kScoreBatchSize) {
+      allScores.scoreAndAddPSMs(batch, rawWeights, featurePool_);
+      batch.clear();
+    }
     ++lineNr;
   } while (getline(dataStream, psmLine));
+  allScores.scoreAndAddPSMs(batch, rawWeights, featurePool_);
   
   if (VERB > 1) {
     std::cerr << "Found " << lineNr - (hasInitialValueRow ? 3u : 2u) << " PSMs" << std::endl;
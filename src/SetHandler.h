@@ -42,6 +42,7 @@
 #include "PseudoRandom.h"
 #include "DescriptionOfCorrect.h"
 #include "FeatureMemoryPool.h"
+#include "FeatureStatistics.h"
 
 using namespace std;
 
@@ -99,13 +100,22 @@ class SetHandler {
   
   FeatureMemoryPool& getFeaturePool() { return featurePool_; }
   
+  // collect the normalization statistics while reading the PSMs, only 
+  // applies to tab delimited input without subset training
+  void setCollectFeatureStatistics(bool on) { collectFeatureStatistics_ = on; }
+  
   void reset();
   
  protected:
+  static const size_t kScoreBatchSize = 4096;
+  
   size_t maxPSMs_;
   vector<DataSet*> subsets_;
   FeatureMemoryPool featurePool_;
   
+  bool collectFeatureStatistics_, hasFeatureStatistics_;
+  FeatureStatistics featureStats_, rtFeatureStats_;
+  
   unsigned int getSubsetIndexFromLabel(int label);
   static inline std::string &rtrim(std::string &s);
   
@@ -58,7 +58,7 @@ void StdvNormalizer::normalizeweight(const std::vector<double>& in,
   out[i] = in[i] + sum;
 }
 
-void StdvNormalizer::setSet(std::vector<double*>& featuresV,
+void StdvNormalizer::setSet(std::vector<FeatureValue*>& featuresV,
                             std::vector<double*>& rtFeaturesV, size_t nf,
                             size_t nrf) {
   numFeatures = nf;
@@ -66,9 +66,10 @@ void StdvNormalizer::setSet(std::vector<double*>& featuresV,
   sub.resize(nf + nrf, 0.0);
   div.resize(nf + nrf, 0.0);
   double n = 0.0;
-  double* features;
+  FeatureValue* features;
+  double* rtFeatures;
   size_t ix;
-  vector<double*>::iterator it = featuresV.begin();
+  vector<FeatureValue*>::iterator it = featuresV.begin();
   for (; it != featuresV.end(); ++it) {
     features = *it;
     n++;
@@ -76,10 +77,11 @@ void StdvNormalizer::setSet(std::vector<double*>& featuresV,
       sub[ix] += features[ix];
     }
   }
-  for (it = rtFeaturesV.begin(); it != rtFeaturesV.end(); ++it) {
-    features = *it;
+  vector<double*>::iterator rtIt = rtFeaturesV.begin();
+  for (; rtIt != rtFeaturesV.end(); ++rtIt) {
+    rtFeatures = *rtIt;
     for (ix = numFeatures; ix < numFeatures + numRetentionFeatures; ++ix) {
-      sub[ix] += features[ix - numFeatures];
+      sub[ix] += rtFeatures[ix - numFeatures];
     }
   }
   if (VERB > 2) {
@@ -105,14 +107,14 @@ void StdvNormalizer::setSet(std::vector<double*>& featuresV,
       div[ix] += d * d;
     }
   }
-  for (it = rtFeaturesV.begin(); it != rtFeaturesV.end(); ++it) {
-    features = *it;
+  for (rtIt = rtFeaturesV.begin(); rtIt != rtFeaturesV.end(); ++rtIt) {
+    rtFeatures = *rtIt;
     for (ix = numFeatures; ix < numFeatures + numRetentionFeatures; ++ix) {
-      if (!isfinite(features[ix-numFeatures])) {
-        cerr << "Reached strange feature with val=" << features[ix
+      if (!isfinite(rtFeatures[ix-numFeatures])) {
+        cerr << "Reached strange feature with val=" << rtFeatures[ix
             - numFeatures] << " at col=" << ix << endl;
       }
-      double d = features[ix - numFeatures] - sub[ix];
+      double d = rtFeatures[ix - numFeatures] - sub[ix];
       div[ix] += d * d;
     }
   }
@@ -134,13 +136,44 @@ void StdvNormalizer::setSet(std::vector<double*>& featuresV,
   }
 }
 
+void StdvNormalizer::setStatistics(const FeatureStatistics& featureStats,
+                                   const FeatureStatistics& rtFeatureStats,
+                                   size_t nf, size_t nrf) {
+  numFeatures = nf;
+  numRetentionFeatures = nrf;
+  sub.resize(nf + nrf, 0.0);
+  div.resize(nf + nrf, 0.0);
+  size_t ix;
+  for (ix = 0; ix < numFeatures + numRetentionFeatures; ++ix) {
+    const FeatureStatistics& stats = (ix < numFeatures) ? 
+        featureStats : rtFeatureStats;
+    size_t col = (ix < numFeatures) ? ix : ix - numFeatures;
+    sub[ix] = stats.getMean(col);
+    div[ix] = stats.getStdv(col);
+    if (div[ix] <= 0) {
+      div[ix] = 1.0;
+    }
+  }
+  if (VERB > 2) {
+    cerr.precision(2);
+    cerr << "Normalization factors" << endl << "Avg ";
+    for (ix = 0; ix < numFeatures + numRetentionFeatures; ++ix) {
+      cerr << "\t" << sub[ix];
+    }
+    cerr << endl << "Stdv";
+    for (ix = 0; ix < numFeatures + numRetentionFeatures; ++ix) {
+      cerr << "\t" << div[ix];
+    }
+    cerr << endl;
+  }
+}
 
-void StdvNormalizer::updateSet(vector<double*> & featuresV, size_t offset,
+void StdvNormalizer::updateSet(vector<FeatureValue*> & featuresV, size_t offset,
                                size_t numFeatures) {
   double n = 0.0;
-  double* features;
+  FeatureValue* features;
   size_t ix;
-  vector<double*>::iterator it = featuresV.begin();
+  vector<FeatureValue*>::iterator it = featuresV.begin();
   for (; it != featuresV.end(); ++it) {
     features = *it;
     n++;
@@ -21,11 +21,14 @@ class StdvNormalizer : public Normalizer { // virtual Normalizer
  public:
   StdvNormalizer();
   virtual ~StdvNormalizer();
-  virtual void setSet(vector<double*> & featuresV,
+  virtual void setSet(vector<FeatureValue*> & featuresV,
                       vector<double*> & rtFeaturesV, size_t numFeatures,
                       size_t numRetentionFeatures);
-  virtual void updateSet(vector<double*> & featuresV, size_t offset,
+  virtual void updateSet(vector<FeatureValue*> & featuresV, size_t offset,
                          size_t numFeatures);
+  virtual void setStatistics(const FeatureStatistics& featureStats,
+                             const FeatureStatistics& rtFeatureStats,
+                             size_t numFeatures, size_t numRetentionFeatures);
   void unnormalizeweight(const vector<double>& in, vector<double>& out);
   void normalizeweight(const vector<double>& in, vector<double>& out);
 };
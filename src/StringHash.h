@@ -0,0 +1,50 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#ifndef STRING_HASH_H_
+#define STRING_HASH_H_
+
+#include <stdint.h>
+#include <cstddef>
+
+/* offset basis and prime of the 64-bit FNV-1a hash */
+static const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+static const uint64_t kFnvPrime = 1099511628211ULL;
+
+/* finalizer of MurmurHash3, makes every bit depend on all bits of the input */
+inline uint64_t mixHash(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/*
+ * 64-bit FNV-1a hash of the characters followed by mixHash, such that both
+ * the low and the high bits of the result depend on all characters
+ */
+inline uint64_t hashString(const char* str, size_t length) {
+  uint64_t hash = kFnvOffsetBasis;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= kFnvPrime;
+  }
+  return mixHash(hash);
+}
+
+#endif /* STRING_HASH_H_ */
@@ -0,0 +1,96 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#include <string.h>
+#include <algorithm>
+
+#include "StringInterner.h"
+#include "StringHash.h"
+
+const int StringInterner::kNotFound;
+
+static const size_t kMinNumSlots = 16;
+
+bool StringInterner::sameString(unsigned int id, const char* str,
+                                size_t length) const {
+  const std::string& stored = strings_[id];
+  return stored.size() == length && memcmp(stored.data(), str, length) == 0;
+}
+
+void StringInterner::reserve(size_t numStrings) {
+  size_t numSlots = kMinNumSlots;
+  while (numSlots < 2 * numStrings) numSlots <<= 1;
+  if (numSlots > slots_.size()) rehash(numSlots);
+}
+
+void StringInterner::rehash(size_t numSlots) {
+  Slot empty = { 0, 0 };
+  slots_.assign(numSlots, empty);
+  size_t mask = numSlots - 1;
+  for (unsigned int id = 0; id < size(); ++id) {
+    uint64_t hash = hashString(strings_[id].data(), strings_[id].size());
+    size_t pos = static_cast<size_t>(hash) & mask;
+    while (slots_[pos].id != 0) pos = (pos + 1) & mask;
+    slots_[pos].hash = static_cast<uint32_t>(hash >> 32);
+    slots_[pos].id = id + 1;
+  }
+}
+
+int StringInterner::find(const char* str, size_t length) const {
+  if (slots_.empty()) return kNotFound;
+  uint64_t hash = hashString(str, length);
+  uint32_t tag = static_cast<uint32_t>(hash >> 32);
+  size_t mask = slots_.size() - 1;
+  for (size_t pos = static_cast<size_t>(hash) & mask; slots_[pos].id != 0;
+       pos = (pos + 1) & mask) {
+    if (slots_[pos].hash == tag && sameString(slots_[pos].id - 1, str, length)) {
+      return static_cast<int>(slots_[pos].id - 1);
+    }
+  }
+  return kNotFound;
+}
+
+unsigned int StringInterner::intern(const char* str, size_t length) {
+  unsigned int id;
+#pragma omp critical (string_interner)
+  id = insert(str, length);
+  return id;
+}
+
+unsigned int StringInterner::insert(const char* str, size_t length) {
+  if (2 * (size() + 1) > slots_.size()) {
+    rehash((std::max)(kMinNumSlots, 2 * slots_.size()));
+  }
+  uint64_t hash = hashString(str, length);
+  uint32_t tag = static_cast<uint32_t>(hash >> 32);
+  size_t mask = slots_.size() - 1;
+  size_t pos = static_cast<size_t>(hash) & mask;
+  for (; slots_[pos].id != 0; pos = (pos + 1) & mask) {
+    if (slots_[pos].hash == tag && sameString(slots_[pos].id - 1, str, length)) {
+      return slots_[pos].id - 1;
+    }
+  }
+  unsigned int id = static_cast<unsigned int>(size());
+  strings_.push_back(std::string(str, length));
+  slots_[pos].hash = tag;
+  slots_[pos].id = id + 1;
+  return id;
+}
+
+void StringInterner::clear() {
+  slots_.clear();
+  strings_.clear();
+}
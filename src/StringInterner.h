@@ -0,0 +1,77 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#ifndef STRING_INTERNER_H_
+#define STRING_INTERNER_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <deque>
+#include <vector>
+
+/*
+* StringInterner stores each distinct string once and hands out consecutive
+* 32-bit ids for them, in order of insertion, so that strings that recur 
+* many times (e.g. protein accessions shared by many PSMs) can be stored and
+* compared as integers.
+*
+* The strings live in a deque, which never moves its elements, and are found
+* through an open addressing hash table with linear probing, which stores 
+* the ids together with part of the hash. Lookups take a pointer and a 
+* length, such that substrings of longer strings can be looked up without 
+* copying them. intern() may be called from several threads while reading 
+* the input; find() and getString() should only be used once reading has 
+* finished.
+*/
+class StringInterner {
+ public:
+  static const int kNotFound = -1;
+
+  void reserve(size_t numStrings);
+
+  // returns the id of the string, adding it if it is new
+  unsigned int intern(const char* str, size_t length);
+  inline unsigned int intern(const std::string& str) {
+    return intern(str.data(), str.size());
+  }
+
+  // returns the id of the string, or kNotFound
+  int find(const char* str, size_t length) const;
+  inline int find(const std::string& str) const {
+    return find(str.data(), str.size());
+  }
+
+  inline const std::string& getString(unsigned int id) const {
+    return strings_[id];
+  }
+  inline size_t size() const { return strings_.size(); }
+  void clear();
+ protected:
+  struct Slot {
+    uint32_t hash; // upper bits of the hash, to skip most comparisons
+    uint32_t id; // id + 1, 0 marks an empty slot
+  };
+
+  std::deque<std::string> strings_;
+  std::vector<Slot> slots_; // power of two size, at most half full
+
+  bool sameString(unsigned int id, const char* str, size_t length) const;
+  void rehash(size_t numSlots);
+  unsigned int insert(const char* str, size_t length);
+};
+
+#endif /* STRING_INTERNER_H_ */
@@ -50,7 +50,7 @@ void UniNormalizer::normalizeweight(const vector<double>& in, vector<
   out[i] = in[i] + sum;
 }
 
-void UniNormalizer::setSet(vector<double*> & featuresV,
+void UniNormalizer::setSet(vector<FeatureValue*> & featuresV,
                            vector<double*> & rtFeaturesV, size_t nf,
                            size_t nrf) {
   numFeatures = nf;
@@ -58,22 +58,24 @@ void UniNormalizer::setSet(vector<double*> & featuresV,
   sub.resize(nf + nrf, 0.0);
   div.resize(nf + nrf, 0.0);
   vector<double> mins(nf + nrf, 1e+100), maxs(nf + nrf, -1e+100);
-  double* features;
+  FeatureValue* features;
+  double* rtFeatures;
   size_t ix;
 
-  vector<double*>::iterator it = featuresV.begin();
+  vector<FeatureValue*>::iterator it = featuresV.begin();
   for (; it != featuresV.end(); ++it) {
     features = *it;
     for (ix = 0; ix < numFeatures; ix++) {
-      mins[ix] = min(features[ix], mins[ix]);
-      maxs[ix] = max(features[ix], maxs[ix]);
+      mins[ix] = min<double>(features[ix], mins[ix]);
+      maxs[ix] = max<double>(features[ix], maxs[ix]);
     }
   }
-  for (it = rtFeaturesV.begin(); it != rtFeaturesV.end(); ++it) {
-    features = *it;
+  vector<double*>::iterator rtIt = rtFeaturesV.begin();
+  for (; rtIt != rtFeaturesV.end(); ++rtIt) {
+    rtFeatures = *rtIt;
     for (ix = numFeatures; ix < numFeatures + numRetentionFeatures; ++ix) {
-      mins[ix] = min(features[ix - numFeatures], mins[ix]);
-      maxs[ix] = max(features[ix - numFeatures], maxs[ix]);
+      mins[ix] = min(rtFeatures[ix - numFeatures], mins[ix]);
+      maxs[ix] = max(rtFeatures[ix - numFeatures], maxs[ix]);
     }
   }
   for (ix = 0; ix < numFeatures + numRetentionFeatures; ++ix) {
@@ -85,18 +87,37 @@ void UniNormalizer::setSet(vector<double*> & featuresV,
   }
 }
 
-void UniNormalizer::updateSet(vector<double*>& featuresV, size_t offset,
+void UniNormalizer::setStatistics(const FeatureStatistics& featureStats,
+                                  const FeatureStatistics& rtFeatureStats,
+                                  size_t nf, size_t nrf) {
+  numFeatures = nf;
+  numRetentionFeatures = nrf;
+  sub.resize(nf + nrf, 0.0);
+  div.resize(nf + nrf, 0.0);
+  for (size_t ix = 0; ix < numFeatures + numRetentionFeatures; ++ix) {
+    const FeatureStatistics& stats = (ix < numFeatures) ? 
+        featureStats : rtFeatureStats;
+    size_t col = (ix < numFeatures) ? ix : ix - numFeatures;
+    sub[ix] = stats.getMin(col);
+    div[ix] = stats.getMax(col) - stats.getMin(col);
+    if (div[ix] <= 0) {
+      div[ix] = 1.0;
+    }
+  }
+}
+
+void UniNormalizer::updateSet(vector<FeatureValue*>& featuresV, size_t offset,
                               size_t numFeatures) {
   vector<double> mins(numFeatures, 1e+100), maxs(numFeatures, -1e+100);
-  double* features;
+  FeatureValue* features;
   size_t ix;
   
-  vector<double*>::iterator it = featuresV.begin();
+  vector<FeatureValue*>::iterator it = featuresV.begin();
   for (; it != featuresV.end(); ++it) {
     features = *it;
     for (ix = 0; ix < numFeatures; ix++) {
-      mins[ix] = min(features[ix], mins[ix]);
-      maxs[ix] = max(features[ix], maxs[ix]);
+      mins[ix] = min<double>(features[ix], mins[ix]);
+      maxs[ix] = max<double>(features[ix], maxs[ix]);
     }
   }
   for (ix = 0; ix < numFeatures; ++ix) {
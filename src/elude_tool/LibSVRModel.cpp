@@ -137,14 +137,30 @@ double LibSVRModel::PredictRT(const int &number_features, double *features) {
   }
 }
 
+void LibSVRModel::PredictRTs(const int &number_features, const vector<double*> &features,
+                             vector<double> &predictions) {
+  if (svr_) {
+    libsvm_wrapper::PredictRTs(svr_, number_features, features, predictions);
+  }
+  else {
+    ostringstream temp;
+    temp << "Error : No SVR model available. Execution aborted." << endl;
+    throw MyException(temp.str());
+  }
+}
+
 /* predict rt for a set of peptides and return the value of the error */
 double LibSVRModel::EstimatePredictionError(const int &number_features, const vector<PSMDescription*> &test_psms) {
-  double ms_error = 0.0, predicted_rt = 0.0, deviation;
-  vector<PSMDescription*>::const_iterator it = test_psms.begin();
+  double ms_error = 0.0, deviation;
+  vector<double*> features(test_psms.size());
+  for (size_t i = 0; i < test_psms.size(); ++i) {
+    features[i] = test_psms[i]->getRetentionFeatures();
+  }
+  vector<double> predicted_rts;
+  PredictRTs(number_features, features, predicted_rts);
 
-  for ( ; it != test_psms.end(); ++it) {
-    predicted_rt =  PredictRT(number_features, (*it)->getRetentionFeatures());
-    deviation = predicted_rt - (*it)->getRetentionTime();
+  for (size_t i = 0; i < test_psms.size(); ++i) {
+    deviation = predicted_rts[i] - test_psms[i]->getRetentionTime();
     ms_error += deviation * deviation;
   }
   return ms_error / (double)test_psms.size();
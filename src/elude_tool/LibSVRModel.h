@@ -60,6 +60,8 @@ class LibSVRModel : public SVRModel {
                           const int &number_features);
    /* predict retention time using the trained model */
    virtual double PredictRT(const int &number_features, double *features);
+   virtual void PredictRTs(const int &number_features, const std::vector<double*> &features,
+                           std::vector<double> &predictions);
    /* predict rt for a set of peptides and return the value of the error */
    double EstimatePredictionError(const int &number_features, const std::vector<PSMDescription*> &test_psms);
    /* perform k-fold cross validation; return error value */
@@ -62,6 +62,20 @@ double libsvm_wrapper::PredictRT(const svm_model* svr, const int &number_feature
   return svm_predict(svr, &node);
 }
 
+void libsvm_wrapper::PredictRTs(const svm_model* svr, const int &number_features,
+    const std::vector<double*> &features, std::vector<double> &predictions) {
+  predictions.resize(features.size());
+  if (features.empty()) {
+    return;
+  }
+  std::vector<svm_node> nodes(features.size());
+  for (size_t i = 0; i < features.size(); ++i) {
+    nodes[i].values = features[i];
+    nodes[i].dim = number_features;
+  }
+  svm_predict_batch(svr, &nodes[0], (int)nodes.size(), &predictions[0]);
+}
+
 int libsvm_wrapper::SaveModel(FILE* fp, const svm_model* model) {
   /*FILE* fp = fopen(model_file_name, "w");
    if (fp == NULL) {
@@ -33,6 +33,9 @@ namespace libsvm_wrapper {
   svm_model* TrainModel(const std::vector<PSMDescription*> &psms, const int &number_features, const svm_parameter &parameter);
   /* predict the retention time of psm using the provided svr */
   double PredictRT(const svm_model* svr, const int &number_features, double *features);
+  /* predict the retention times of several psms in one batch */
+  void PredictRTs(const svm_model* svr, const int &number_features,
+                  const std::vector<double*> &features, std::vector<double> &predictions);
   /* save/load a model to/from a file*/
   int SaveModel(FILE* fp, const svm_model* model);
   svm_model* LoadModel(FILE* fp);
@@ -42,7 +42,7 @@ RetentionModel::~RetentionModel() {
 int RetentionModel::NormalizeFeatures(const bool set_set,
     std::vector<PSMDescription*> &psms) {
   //cout << psms[0] << endl;
-  vector<double*> tmp;
+  vector<FeatureValue*> tmp;
   vector<double*> tmp_ret_feat = PSMDescriptionDOC::getRetFeatures(psms);
   int number_active_features = retention_features_.GetTotalNumberFeatures();
   the_normalizer_->resizeVecs(number_active_features);
@@ -258,14 +258,17 @@ int RetentionModel::PredictRT(const set<string> &aa_alphabet, const bool ignore_
   retention_features_.ComputeRetentionFeatures(psms);
     // normalize the features
   NormalizeFeatures(false, psms);
-  double predicted_rt;
   PSMDescriptionDOC::normDivRT_ = div_;
   PSMDescriptionDOC::normSubRT_ = sub_;
   int number_features = retention_features_.GetTotalNumberFeatures();
-  vector<PSMDescription*>::iterator it = psms.begin();
-  for( ; it != psms.end(); ++it) {
-    predicted_rt = svr_model_->PredictRT(number_features, (*it)->getRetentionFeatures());
-    (*it)->setPredictedRetentionTime(PSMDescriptionDOC::unnormalize(predicted_rt));
+  vector<double*> features(psms.size());
+  for (size_t i = 0; i < psms.size(); ++i) {
+    features[i] = psms[i]->getRetentionFeatures();
+  }
+  vector<double> predicted_rts;
+  svr_model_->PredictRTs(number_features, features, predicted_rts);
+  for (size_t i = 0; i < psms.size(); ++i) {
+    psms[i]->setPredictedRetentionTime(PSMDescriptionDOC::unnormalize(predicted_rts[i]));
   }
   if (VERB >= 4) {
     cerr << "Done." << endl << endl;
@@ -39,6 +39,14 @@ class SVRModel {
    virtual int TrainModel(const std::vector<PSMDescription*>& train_psms, const int &number_features) = 0;
    /* predict retention time using the trained model */
    virtual double PredictRT(const int &number_features, double *features) = 0;
+   /* predict the retention times of several peptides; predictions[i] is the rt of features[i] */
+   virtual void PredictRTs(const int &number_features, const std::vector<double*> &features,
+                           std::vector<double> &predictions) {
+     predictions.resize(features.size());
+     for (size_t i = 0; i < features.size(); ++i) {
+       predictions[i] = PredictRT(number_features, features[i]);
+     }
+   }
    /* save a svr model */
    virtual int SaveModel(FILE *fp) = 0;
    /* load a svr model */
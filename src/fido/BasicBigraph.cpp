@@ -2,6 +2,7 @@
 // see license for more information
 
 #include "BasicBigraph.h"
+#include "DisjointSet.h"
 
 BasicBigraph::BasicBigraph(): PsmThreshold(0.0), PeptideThreshold(1e-3),
   ProteinThreshold(1e-3) {}
@@ -13,11 +14,21 @@ BasicBigraph::BasicBigraph(double __psmthreshold, double __peptidethreshold,
 
 BasicBigraph::~BasicBigraph() {}
 
+/*
+* Builds the graph directly from the scored PSMs. Proteins are looked up by 
+*   their interned protein id, so that each protein name is only cleaned and
+*   hashed once, and the edges are collected as index pairs that are sorted
+*   and made unique before the associations are filled in a single pass.
+*/
 void BasicBigraph::read(Scores* fullset, bool multiple_labeled_peptides) {
-  string pepName, protName;
+  string pepName;
   double value =  -10;
-  int pepIndex = -1;
   StringTable PSMNames, proteinNames;
+  
+  // graph index of each interned protein id, -1 if not seen yet
+  std::vector<int> proteinIndex(PSMDescription::getNumProteinIdStrings(), -1);
+  std::vector<std::pair<int, int> > edges;
+  edges.reserve(fullset->size());
 
   vector<ScoreHolder>::iterator psm = fullset->begin();
   for (; psm!= fullset->end(); ++psm) {
@@ -40,24 +51,38 @@ void BasicBigraph::read(Scores* fullset, bool multiple_labeled_peptides) {
       pepName += "*";
     }
     
-    if ( PSMNames.lookup(pepName) == -1 ){
-      add(PSMsToProteins, PSMNames, pepName);
+    int pepIndex = PSMNames.insert(pepName);
+    if (pepIndex == PSMsToProteins.size()) {
+      addNode(PSMsToProteins);
     }
-    pepIndex = PSMNames.lookup(pepName);
 
     // r proteins
-    std::vector<string>::const_iterator pid = psm->pPSM->proteinIds.begin();
+    std::vector<unsigned int>::const_iterator pid = psm->pPSM->proteinIds.begin();
     for (; pid!= psm->pPSM->proteinIds.end(); ++pid) {
-      protName = getRidOfUnprintablesAndUnicode(*pid);
-      if (proteinNames.lookup(protName) == -1) {
-        add(proteinsToPSMs, proteinNames, protName);
+      int& protIndex = proteinIndex[*pid];
+      if (protIndex == -1) {
+        protIndex = proteinNames.insert(getRidOfUnprintablesAndUnicode(
+            PSMDescription::getProteinIdString(*pid)));
+        if (protIndex == proteinsToPSMs.size()) {
+          addNode(proteinsToPSMs);
+        }
       }
-      connect(PSMNames, pepName, proteinNames, protName);
+      edges.push_back(std::make_pair(pepIndex, protIndex));
     }
     // p probability of the peptide match to the spectrum
     value = 1 - psm->pep;
     PSMsToProteins.weights[ pepIndex ] = max(PSMsToProteins.weights[pepIndex], value);
- }
+  }
+  
+  // the edges are ordered by peptide, so both association sets are filled 
+  // in increasing order
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  std::vector<std::pair<int, int> >::const_iterator edge = edges.begin();
+  for (; edge != edges.end(); ++edge) {
+    PSMsToProteins.associations[ edge->first ].add(edge->second);
+    proteinsToPSMs.associations[ edge->second ].add(edge->first);
+  }
 
   PSMsToProteins.names = PSMNames.getItemsByNumber();
   proteinsToPSMs.names = proteinNames.getItemsByNumber();
@@ -184,14 +209,14 @@ void BasicBigraph::clonePSM(int pepIndex) {
   const Set & s = PSMsToProteins.associations[pepIndex];
   for (int k = 0; k < s.size(); k++) {
     int sect = proteinsToPSMs[ s[k] ].section;
-    sections |= Set::SingletonSet(sect);
+    sections.insert(sect);
   }
   // index the proteins by the sections they belong to
   Array<Set> associatedProteinsBySection(sections.size());
   for (int k = 0; k < s.size(); k++) {
     int sect = proteinsToPSMs.sections[ s[k] ];
     int ind = sections.find(sect);
-    associatedProteinsBySection[ ind ] |= Set::SingletonSet(s[k]);
+    associatedProteinsBySection[ ind ].insert(s[k]);
   }
   // add a clone for each of the sections-- include the first one,
   // since it will be easier to build them all than to have a special
@@ -209,7 +234,7 @@ void BasicBigraph::clonePSM(int pepIndex) {
 
     // add the association from this section's proteins to the new peptide
     for (int j = 0; j<associatedProteinsBySection[k].size(); j++)
-      proteinsToPSMs.associations[ associatedProteinsBySection[k][j] ] |= Set::SingletonSet( PSMsToProteins.size()-1 );
+      proteinsToPSMs.associations[ associatedProteinsBySection[k][j] ].insert( PSMsToProteins.size()-1 );
   }
 
   // afterward, erase the original
@@ -217,7 +242,7 @@ void BasicBigraph::clonePSM(int pepIndex) {
   for (int k = 0; k < associatedProteinsBySection.size(); k++) {
     for (int j = 0; j < associatedProteinsBySection[k].size(); j++) {
       int prot = associatedProteinsBySection[k][j];
-      proteinsToPSMs[prot].association = proteinsToPSMs[prot].association.without( Set::SingletonSet(pepIndex) );
+      proteinsToPSMs.associations[prot].erase(pepIndex);
     }
   }
 
@@ -248,14 +273,24 @@ void BasicBigraph::reindex() {
   Array<string> backupSeveredProteins = severedProteins;
   double backupPeptideThreshold = PeptideThreshold;
 
-  *this = buildSubgraph(connectedProteins, connectedPSMs);
+  Array<int> proteinIndex(proteinsToPSMs.size(), -1), psmIndex(PSMsToProteins.size(), -1);
+  *this = buildSubgraph(connectedProteins, connectedPSMs, proteinIndex, psmIndex);
   numberClones = backupNumberClones;
   severedProteins = backupSeveredProteins;
   PeptideThreshold = backupPeptideThreshold;
 }
 
-BasicBigraph BasicBigraph::buildSubgraph(const Set & connectedProteins, const Set & connectedPSMs) {
+// proteinIndex and psmIndex have to be -1 for all nodes; they are used to map
+// the nodes to their index in the subgraph and are reset afterwards
+BasicBigraph BasicBigraph::buildSubgraph(const Set & connectedProteins, 
+    const Set & connectedPSMs, Array<int> & proteinIndex, Array<int> & psmIndex) {
   BasicBigraph result;
+  for (int k = 0; k < connectedProteins.size(); k++) {
+    proteinIndex[ connectedProteins[k] ] = k;
+  }
+  for (int k = 0; k < connectedPSMs.size(); k++) {
+    psmIndex[ connectedPSMs[k] ] = k;
+  }
 
   result.PSMsToProteins.names = PSMsToProteins.names[ connectedPSMs ];
   result.PSMsToProteins.associations = PSMsToProteins.associations[ connectedPSMs ];
@@ -263,7 +298,7 @@ BasicBigraph BasicBigraph::buildSubgraph(const Set & connectedProteins, const Se
   result.PSMsToProteins.sections = PSMsToProteins.sections[ connectedPSMs ];
 
   for (int k = 0; k < result.PSMsToProteins.associations.size(); k++) {
-    result.PSMsToProteins.associations[k] = result.PSMsToProteins.associations[k].reindexToFind( connectedProteins );
+    result.PSMsToProteins.associations[k] = result.PSMsToProteins.associations[k].reindexBy( proteinIndex );
   }
 
   result.proteinsToPSMs.names = proteinsToPSMs.names[ connectedProteins ];
@@ -272,9 +307,15 @@ BasicBigraph BasicBigraph::buildSubgraph(const Set & connectedProteins, const Se
   result.proteinsToPSMs.sections = proteinsToPSMs.sections[ connectedProteins ];
 
   for (int k = 0; k < result.proteinsToPSMs.associations.size(); k++) {
-    result.proteinsToPSMs.associations[k] = result.proteinsToPSMs.associations[k].reindexToFind( connectedPSMs );
+    result.proteinsToPSMs.associations[k] = result.proteinsToPSMs.associations[k].reindexBy( psmIndex );
   }
 
+  for (int k = 0; k < connectedProteins.size(); k++) {
+    proteinIndex[ connectedProteins[k] ] = -1;
+  }
+  for (int k = 0; k < connectedPSMs.size(); k++) {
+    psmIndex[ connectedPSMs[k] ] = -1;
+  }
   return result;
 }
 
@@ -288,7 +329,12 @@ void BasicBigraph::removePoorPSMs() {
 
 void BasicBigraph::removePoorProteins() {
   for (int k = 0; k < proteinsToPSMs.size(); k++) {
-    if (Vector(PSMsToProteins.weights[ proteinsToPSMs.associations[k] ]).max() < ProteinThreshold) {
+    const Set & as = proteinsToPSMs.associations[k];
+    double maxWeight = -Numerical::inf();
+    for (int j = 0; j < as.size(); j++) {
+      maxWeight = max(maxWeight, PSMsToProteins.weights[ as[j] ]);
+    }
+    if (maxWeight < ProteinThreshold) {
       disconnectProtein(k);
     }
   }
@@ -297,8 +343,7 @@ void BasicBigraph::removePoorProteins() {
 void BasicBigraph::disconnectPSM(int k) {
   Set& as = PSMsToProteins.associations[k];
   for (Set::Iterator iter = as.begin(); iter != as.end(); iter++) {
-    Set& setRef = proteinsToPSMs.associations[ *iter ];
-    setRef = setRef.without( Set::SingletonSet( k ) );
+    proteinsToPSMs.associations[ *iter ].erase(k);
   }
   as = Set();
 }
@@ -306,8 +351,7 @@ void BasicBigraph::disconnectPSM(int k) {
 void BasicBigraph::disconnectProtein(int k) {
   Set & as = proteinsToPSMs.associations[k];
   for (Set::Iterator iter = as.begin(); iter != as.end(); iter++) {
-    Set & setRef = PSMsToProteins.associations[ *iter ];
-    setRef = setRef.without( Set::SingletonSet( k ) );
+    PSMsToProteins.associations[ *iter ].erase(k);
   }
   as = Set();
 }
@@ -316,22 +360,23 @@ void BasicBigraph::add(GraphLayer & gl, StringTable & st, const string & item) {
   if ( st.lookup(item) == -1 ) {
     // if the string is not already known, then add a new node for it
     st.add(item);
-    gl.associations.add( Set() );
-    gl.weights.add( -1.0 );
-    gl.sections.add(-1);
+    addNode(gl);
   }
 }
 
+void BasicBigraph::addNode(GraphLayer & gl) {
+  gl.associations.add( Set() );
+  gl.weights.add( -1.0 );
+  gl.sections.add(-1);
+}
+
 void BasicBigraph::connect(const StringTable & pepNames, const string & pepName, const StringTable & proteinNames, const string & protName)
 {
   int pepIndex = pepNames.lookup(pepName);
   int protIndex = proteinNames.lookup(protName);
 
-  // performance note: currently O(n^2) worstcase. Later use a bitset
-  // and then after the graph is read, pack it into a set. 
-
-  PSMsToProteins.associations[ pepIndex ] |= Set::SingletonSet(protIndex);
-  proteinsToPSMs.associations[ protIndex ] |= Set::SingletonSet(pepIndex);
+  PSMsToProteins.associations[ pepIndex ].insert(protIndex);
+  proteinsToPSMs.associations[ protIndex ].insert(pepIndex);
 }
 
 void BasicBigraph::printProteinWeights() const
@@ -346,29 +391,14 @@ void BasicBigraph::printProteinWeights() const
     }
 }
 
-void BasicBigraph::traceConnected(int index, GraphLayer & gl, int sectionNumber) {
-  if ( gl.sections[index] == sectionNumber )
-    return;
-  
-  // if it has not already been marked by this section, do so
-  gl.sections[index] = sectionNumber;
-  // add mark to set of marks for this node, set can only be larger than 1 for 
-  // peptides below PeptideThreshold
-  gl.sectionMarks[index] |= Set::SingletonSet(sectionNumber);
-  
-  // do not follow edges with PSM probability below PeptideThreshold
-  if (&gl == &PSMsToProteins && gl.weights[index] <= PeptideThreshold)
-    return;
-
-  const Set& as = gl.associations[index];
-  for (Set::Iterator iter = as.begin(); iter != as.end(); iter++) {
-    if ( &gl == &proteinsToPSMs )
-      traceConnected(*iter, PSMsToProteins, sectionNumber);
-    else
-      traceConnected(*iter, proteinsToPSMs, sectionNumber);
-  }
-}
-
+/*
+* Marks the connected sections of the graph with a union-find over the 
+*   proteins. Proteins are connected through PSMs with a probability above 
+*   PeptideThreshold, and proteins with equal peptide evidence are put in the 
+*   same section. Sections are numbered in order of their first protein. 
+*   PSMs at or below PeptideThreshold do not connect proteins and get a mark 
+*   for every section they associate with.
+*/
 int BasicBigraph::markSectionPartitions() {
   // returns the number of sections that are found
   proteinsToPSMs.sectionMarks = Array<Set>(proteinsToPSMs.size());
@@ -377,32 +407,47 @@ int BasicBigraph::markSectionPartitions() {
   PSMsToProteins.sections = Array<int>(PSMsToProteins.size(), -1);
   proteinsToPSMs.sections = Array<int>(proteinsToPSMs.size(), -1);
   
+  DisjointSet components(proteinsToPSMs.size());
+  
   // MT: make sure proteins with equal peptide evidence end up in the same section
   Array<Set> groups = ReplicateIndexer<Set>::replicates(Set::sumSetElements, proteinsToPSMs.associations );
-  std::map<int, int> mapToFirstInGroup;
-  
   for (int k = 0; k < groups.size(); k++) {
-    Set reps = groups[k].without( Set::SingletonSet(groups[k][0]) );
-    for (Set::Iterator iter = reps.begin(); iter != reps.end(); iter++) {
-      mapToFirstInGroup[*iter] = groups[k][0];
+    for (int j = 1; j < groups[k].size(); j++) {
+      components.unite(groups[k][0], groups[k][j]);
+    }
+  }
+  
+  // do not follow edges with PSM probability below PeptideThreshold
+  for (int k = 0; k < PSMsToProteins.size(); k++) {
+    const Set & as = PSMsToProteins.associations[k];
+    if (PSMsToProteins.weights[k] > PeptideThreshold) {
+      for (int j = 1; j < as.size(); j++) {
+        components.unite(as[0], as[j]);
+      }
     }
   }
   
-  int section = 0;
+  std::vector<int> proteinSections;
+  int numSections = components.label(proteinSections);
   for (int k = 0; k < proteinsToPSMs.size(); k++) {
-    if (mapToFirstInGroup.find(k) != mapToFirstInGroup.end()) {
-      int sectionNumber = proteinsToPSMs.sections[mapToFirstInGroup[k]];
-      proteinsToPSMs.sections[k] = sectionNumber;
-      // add mark to set of marks for this node, set can only be larger than 1 for 
-      // peptides below PeptideThreshold
-      proteinsToPSMs.sectionMarks[k] |= Set::SingletonSet(sectionNumber);
-    } else if (proteinsToPSMs[k].section == -1) {
-      traceConnected(k, proteinsToPSMs, section);
-      section++;
+    proteinsToPSMs.sections[k] = proteinSections[k];
+    proteinsToPSMs.sectionMarks[k].add(proteinSections[k]);
+  }
+  
+  // set of marks can only be larger than 1 for peptides below PeptideThreshold,
+  // the PSM keeps the last of its sections
+  for (int k = 0; k < PSMsToProteins.size(); k++) {
+    const Set & as = PSMsToProteins.associations[k];
+    Set & marks = PSMsToProteins.sectionMarks[k];
+    for (int j = 0; j < as.size(); j++) {
+      marks.insert(proteinSections[ as[j] ]);
+    }
+    if (!marks.isEmpty()) {
+      PSMsToProteins.sections[k] = marks.back();
     }
   }
 
-  return section;
+  return numSections;
 }
 
 Array<BasicBigraph> BasicBigraph::partitionSections() {
@@ -419,9 +464,10 @@ Array<BasicBigraph> BasicBigraph::partitionSections() {
 
   // now reindex them to their proper sets
 
+  Array<int> proteinIndex(proteinsToPSMs.size(), -1), psmIndex(PSMsToProteins.size(), -1);
   Array<BasicBigraph> result;
   for (int k = 0; k < numSections; k++) {
-    result.add( buildSubgraph( proteinSubsets[k], PSMSubsets[k] ) );
+    result.add( buildSubgraph( proteinSubsets[k], PSMSubsets[k], proteinIndex, psmIndex ) );
   }
 
   return result;
@@ -89,6 +89,7 @@ class BasicBigraph {
 protected:
   
   void add(GraphLayer & gl, StringTable & st, const string & item);
+  void addNode(GraphLayer & gl);
   void connect(const StringTable & PSMNames, const string & pepStr, 
 	       const StringTable & proteinNames, const string & protStr);
   void disconnectProtein(int k);
@@ -105,8 +106,8 @@ protected:
   void clonePSM(int pepIndex);
   void saveSeveredProteins();
   
-  BasicBigraph buildSubgraph(const Set & connectedProteins, const Set & connectedPSMs);
-  void traceConnected(int index, GraphLayer & gl, int sectionNumber);
+  BasicBigraph buildSubgraph(const Set & connectedProteins, const Set & connectedPSMs,
+                            Array<int> & proteinIndex, Array<int> & psmIndex);
 
   double PsmThreshold;
   double PeptideThreshold;
@@ -192,26 +192,139 @@ double BasicGroupBigraph::probabilityNGivenD(const Model & m, const Array<Counte
   return pow(2.0, logLike);
 }
 
-double BasicGroupBigraph::logLikelihoodConstant(const Model & m) const {
-  double result = 0.0;
-  bool starting = true;
-
+/*
+* Enumerates all configurations of the protein groups in reflected mixed-radix
+*   Gray code order, i.e. a single group changes its state by one in each 
+*   step. The number of active proteins and the likelihood terms then only 
+*   have to be updated for the PSMs associated with that group, instead of 
+*   recomputing the likelihood over all PSMs for every configuration.
+*/
+void BasicGroupBigraph::enumerateConfigurations(const Model & m, ConfigurationVisitor & visitor) const {
+  int numPSMs = PSMsToProteins.size();
+  int numGroups = originalN.size();
+  
+  // log2 of the likelihood term of each PSM, given its number of active
+  // associated proteins; terms with zero likelihood are counted separately
+  // so that they can be added and removed again
+  Array<Array<double> > logTerms(numPSMs);
+  Array<int> active(numPSMs, 0);
+  double logLike = 0.0;
+  int numZeroTerms = 0;
+  for (int k = 0; k < numPSMs; k++) {
+    int a = numberAssociatedProteins(k);
+    logTerms[k] = Array<double>(a+1);
+    for (int j = 0; j <= a; j++) {
+      double probEGivenD = PSMsToProteins.weights[k];
+      double probEGivenN = probabilityEEpsilonGivenActiveAssociatedProteins(m, j);
+      double probE = PeptidePrior;
+      double termE = probEGivenD / probE * probEGivenN;
+      double termNotE = (1-probEGivenD) / (1-probE) * (1-probEGivenN);
+      logTerms[k][j] = log2(termE + termNotE);
+    }
+    if ( std::isinf(logTerms[k][0]) ) numZeroTerms++;
+    else logLike += logTerms[k][0];
+  }
+  
+  // log2 of the prior probability of each state of each group
+  Array<Array<double> > logPriors(numGroups);
+  double logPrior = 0.0;
+  for (int k = 0; k < numGroups; k++) {
+    int size = originalN[k].size;
+    logPriors[k] = Array<double>(size+1);
+    for (int j = 0; j <= size; j++) {
+      logPriors[k][j] = m.logProbabilityProteins(size, j);
+    }
+    logPrior += logPriors[k][0];
+  }
+  
   Array<Counter> n = originalN;
+  Counter::start(n);
+  Array<int> direction(numGroups, 1);
+  while (true) {
+    visitor.visit(n, numZeroTerms > 0 ? -Numerical::inf() : logLike + logPrior);
+    
+    // move the lowest group that has not reached the end of its range
+    // in its current direction, and reverse the direction of the groups below
+    int g = 0;
+    for ( ; g < numGroups; g++) {
+      int next = n[g].state + direction[g];
+      if (next >= 0 && next <= n[g].size) break;
+      direction[g] = -direction[g];
+    }
+    if (g == numGroups) break;
+    
+    int oldState = n[g].state;
+    n[g].state += direction[g];
+    logPrior += logPriors[g][ n[g].state ] - logPriors[g][oldState];
+    
+    const Set & s = proteinsToPSMs.associations[g];
+    for (int k = 0; k < s.size(); k++) {
+      int psm = s[k];
+      double oldTerm = logTerms[psm][ active[psm] ];
+      active[psm] += direction[g];
+      double newTerm = logTerms[psm][ active[psm] ];
+      
+      if ( std::isinf(oldTerm) ) numZeroTerms--;
+      else logLike -= oldTerm;
+      if ( std::isinf(newTerm) ) numZeroTerms++;
+      else logLike += newTerm;
+    }
+  }
+}
 
-  for (Counter::start(n); Counter::inRange(n); Counter::advance(n)) {
-    double L = logLikelihoodNGivenD(m, n);
-    double p = log2(probabilityN(m, n));
-    double logLikeTerm = L+p;
-
-    if ( starting ) {
-      starting = false;
-      result = logLikeTerm;
-    } else {
+namespace {
+  // sums the likelihood of all configurations in log space
+  class LogLikelihoodSum : public ConfigurationVisitor {
+   public:
+    LogLikelihoodSum() : result(-Numerical::inf()) {}
+    void visit(const Array<Counter> & n, double logLikeTerm) {
       result = Numerical::logAdd(result, logLikeTerm);
     }
-  }
+    double result;
+  };
+  
+  // sums the expected fraction of present proteins of each group over all
+  // configurations, weighted by the posterior of the configuration. The 
+  // normalizing constant is summed in the same pass: the terms are scaled 
+  // relative to the largest log likelihood seen so far, and the sums are 
+  // rescaled whenever that maximum increases
+  class ExpectedGroupStates : public ConfigurationVisitor {
+   public:
+    ExpectedGroupStates(int numGroups) : 
+      sums(numGroups, 0.0), likelihoodSum(0.0), logMax(-Numerical::inf()) {}
+    void visit(const Array<Counter> & n, double logLikeTerm) {
+      if ( std::isinf(logLikeTerm) ) return;
+      if (logLikeTerm > logMax) {
+        double scale = pow(2.0, logMax - logLikeTerm);
+        for (int k = 0; k < sums.size(); k++) {
+          sums[k] *= scale;
+        }
+        likelihoodSum *= scale;
+        logMax = logLikeTerm;
+      }
+      double likelihood = pow(2.0, logLikeTerm - logMax);
+      likelihoodSum += likelihood;
+      for (int k = 0; k < n.size(); k++) {
+        sums[k] += likelihood * double(n[k].state) / n[k].size;
+      }
+    }
+    Array<double> result() const {
+      Array<double> probs(sums.size());
+      for (int k = 0; k < sums.size(); k++) {
+        probs[k] = sums[k] / likelihoodSum;
+      }
+      return probs;
+    }
+   private:
+    Array<double> sums;
+    double likelihoodSum, logMax;
+  };
+}
 
-  return result;
+double BasicGroupBigraph::logLikelihoodConstant(const Model & m) const {
+  LogLikelihoodSum sum;
+  enumerateConfigurations(m, sum);
+  return sum.result;
 }
 
 double BasicGroupBigraph::likelihoodConstant(const Model & m) const {
@@ -266,21 +379,10 @@ double BasicGroupBigraph::eCorrectionEpsilon(int indexEpsilon, const Model & m,
   return termE / term;
 }
 
-Array<double> BasicGroupBigraph::probabilityRGivenD(const Model & m) {
-  Array<Counter> n = originalN;
-  Vector result;
-
-  for (Counter::start(n); Counter::inRange(n); Counter::advance(n)) {
-    Vector term = probabilityNGivenD(m, n) * Vector( probabilityRGivenN(n) );
-
-    if ( result.size() == 0 ) {
-      result = term;
-    } else {
-      result += term;
-    }
-  }
-
-  return result.unpack();
+Array<double> BasicGroupBigraph::probabilityRGivenD(const Model & m) const {
+  ExpectedGroupStates expected(originalN.size());
+  enumerateConfigurations(m, expected);
+  return expected.result();
 }
 
 Array<double> BasicGroupBigraph::probabilityRGivenN(const Array<Counter> & n) {
@@ -303,6 +405,10 @@ void BasicGroupBigraph::getProteinProbs(const Model & m) {
   probabilityR = probabilityRGivenD(m);
 }
 
+Array<double> BasicGroupBigraph::computeProteinProbs(const Model & m) const {
+  return probabilityRGivenD(m);
+}
+
 double BasicGroupBigraph::probabilityEEpsilonOverAllAlphaBeta(const GridModel & gm, int indexEpsilon) const {
   GridModel localModel( gm );
 
@@ -333,6 +439,7 @@ double BasicGroupBigraph::logLikelihoodAlphaBetaGivenD(const GridModel & gm) con
 void BasicGroupBigraph::setPeptidePrior(double __peptide_prior)
 {
   PeptidePrior = __peptide_prior;
+  refreshCache();
 }
 
 double BasicGroupBigraph::getPeptidePrior()
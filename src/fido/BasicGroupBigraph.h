@@ -68,6 +68,18 @@ class Counter {
   }
 };
 
+/*
+* ConfigurationVisitor receives the configurations of the protein groups, 
+*   together with their log likelihood log2( P(D|n) * P(n) ), from 
+*   BasicGroupBigraph::enumerateConfigurations
+*
+*/
+class ConfigurationVisitor {
+ public:
+  virtual ~ConfigurationVisitor() {}
+  virtual void visit(const Array<Counter> & n, double logLikeTerm) = 0;
+};
+
 /*
 * BasicGroupBigraph extends BasicBigraph by allowing proteins to be 
 *   grouped (=clustered). This brings the added complexity of multiple possible
@@ -87,6 +99,7 @@ class BasicGroupBigraph : public BasicBigraph {
     BasicBigraph::read(fullset);
     if (noClustering_) trivialGroupProteins();
     else groupProteins();
+    refreshCache();
   }
    
   // for partitioning
@@ -96,6 +109,9 @@ class BasicGroupBigraph : public BasicBigraph {
   
   double logNumberOfConfigurations() const;
   void getProteinProbs(const Model& m);
+  // the same probabilities as getProteinProbs, but returned instead of 
+  // stored, such that several threads can share the graph
+  Array<double> computeProteinProbs(const Model& m) const;
   void printProteinWeights() const;
 
   const Array<double>& proteinProbabilities() const { return probabilityR; }
@@ -146,10 +162,12 @@ class BasicGroupBigraph : public BasicBigraph {
   double probabilityNNu(const Model& m, const Counter & nNu) const;
   double probabilityNGivenD(const Model& m, const Array<Counter> & n) const;
 
+  void enumerateConfigurations(const Model& m, ConfigurationVisitor & visitor) const;
+
   double logLikelihoodConstant(const Model& m) const;
   double likelihoodConstant(const Model& m) const;
 
-  Array<double> probabilityRGivenD(const Model& m);
+  Array<double> probabilityRGivenD(const Model& m) const;
   Array<double> probabilityRGivenN(const Array<Counter> & n);
   double probabilityRRhoGivenN(int indexRho, const Array<Counter> & n);
 
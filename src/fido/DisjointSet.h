@@ -0,0 +1,80 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+
+#ifndef _DisjointSet_H
+#define _DisjointSet_H
+
+#include <vector>
+
+/*
+* DisjointSet is a union-find structure over the integers 0..n-1, with union
+*   by rank and path halving, used to find the connected components of a
+*   graph without recursion.
+*
+*/
+class DisjointSet {
+ public:
+  explicit DisjointSet(int n) : parent_(n), rank_(n, 0) {
+    for (int k = 0; k < n; k++) {
+      parent_[k] = k;
+    }
+  }
+
+  int find(int x) {
+    while (parent_[x] != x) {
+      parent_[x] = parent_[ parent_[x] ];
+      x = parent_[x];
+    }
+    return x;
+  }
+
+  void unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (rank_[a] < rank_[b]) {
+      parent_[a] = b;
+    } else {
+      parent_[b] = a;
+      if (rank_[a] == rank_[b]) rank_[a]++;
+    }
+  }
+
+  // numbers the components in order of their smallest element, stores the
+  // component number of each element in componentOf and returns the number
+  // of components
+  int label(std::vector<int> & componentOf) {
+    int n = parent_.size();
+    std::vector<int> rootLabel(n, -1);
+    componentOf.resize(n);
+    int numComponents = 0;
+    for (int k = 0; k < n; k++) {
+      int root = find(k);
+      if (rootLabel[root] == -1) {
+        rootLabel[root] = numComponents++;
+      }
+      componentOf[k] = rootLabel[root];
+    }
+    return numComponents;
+  }
+
+ private:
+  std::vector<int> parent_;
+  std::vector<int> rank_;
+};
+
+#endif
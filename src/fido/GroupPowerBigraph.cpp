@@ -1,19 +1,73 @@
 // Written by Oliver Serang 2009
 // see license for more information
 
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "GroupPowerBigraph.h"
 
 GroupPowerBigraph::~GroupPowerBigraph() { }
 
+/**
+ * The subgraphs are independent, so their probabilities are computed in
+ * parallel, starting with the largest subgraphs since a few hub subgraphs
+ * dominate the run time. The results are appended in the original subgraph
+ * order, independent of the number of threads.
+ */
 Array<double> GroupPowerBigraph::proteinProbs() {
+  std::vector<int> order = subgraphsBySize();
+  int numSubgraphs = order.size();
+  
+  #pragma omp parallel for schedule(dynamic, 1) if(numSubgraphs > 1)
+  for (int i = 0; i < numSubgraphs; i++) {
+    subgraphs_[order[i]].getProteinProbs(params_);
+  }
+  
   Array<double> result;
-  for (int k = 0; k < subgraphs_.size(); k++) {
-    subgraphs_[k].getProteinProbs(params_);
+  for (int k = 0; k < numSubgraphs; k++) {
     result.append( subgraphs_[k].proteinProbabilities() );
   }
   return result;
 }
 
+/**
+ * As proteinProbs(), but for the given parameters and without changing the
+ * graph or its caches, such that several threads can evaluate different 
+ * parameters on the same graph.
+ */
+Array<double> GroupPowerBigraph::proteinProbs(const Model& m) const {
+  std::vector<int> order = subgraphsBySize();
+  int numSubgraphs = order.size();
+  std::vector<Array<double> > subgraphProbs(numSubgraphs);
+  
+  #pragma omp parallel for schedule(dynamic, 1) if(numSubgraphs > 1)
+  for (int i = 0; i < numSubgraphs; i++) {
+    subgraphProbs[order[i]] = subgraphs_[order[i]].computeProteinProbs(m);
+  }
+  
+  Array<double> result;
+  for (int k = 0; k < numSubgraphs; k++) {
+    result.append( subgraphProbs[k] );
+  }
+  return result;
+}
+
+/* indices of the subgraphs by descending number of configurations */
+std::vector<int> GroupPowerBigraph::subgraphsBySize() const {
+  int numSubgraphs = subgraphs_.size();
+  std::vector<std::pair<double, int> > order(numSubgraphs);
+  for (int k = 0; k < numSubgraphs; k++) {
+    order[k] = std::make_pair(-subgraphs_[k].logNumberOfConfigurations(), k);
+  }
+  std::sort(order.begin(), order.end());
+  
+  std::vector<int> indices(numSubgraphs);
+  for (int k = 0; k < numSubgraphs; k++) {
+    indices[k] = order[k].second;
+  }
+  return indices;
+}
+
 void GroupPowerBigraph::getProteinProbs() {
   probsPresentProteins_ = proteinProbs();
 }
@@ -86,10 +140,23 @@ void GroupPowerBigraph::getProteinNames(std::vector<std::vector<std::string> > &
 void GroupPowerBigraph::getProteinProbsAndNames(
     std::vector<std::vector<std::string> > &names, 
     std::vector<double> &probs) const {
+  getProteinProbsAndNames(probsPresentProteins_, names, probs);
+}
+
+void GroupPowerBigraph::getProteinProbsAndNames(const Model& m,
+    std::vector<std::vector<std::string> > &names, 
+    std::vector<double> &probs) const {
+  getProteinProbsAndNames(proteinProbs(m), names, probs);
+}
+
+void GroupPowerBigraph::getProteinProbsAndNames(
+    const Array<double>& probsPresent,
+    std::vector<std::vector<std::string> > &names, 
+    std::vector<double> &probs) const {
   names.clear();
   probs.clear();
   
-  Array<double> sorted = probsPresentProteins_;
+  Array<double> sorted = probsPresent;
   Array<int> indices = sorted.sort();
   for (int k=0; k<sorted.size(); k++) {
     double pep = (1.0 - sorted[k]);
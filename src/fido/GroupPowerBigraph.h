@@ -38,11 +38,13 @@ class GroupPowerBigraph {
   ~GroupPowerBigraph();
   
   Array<double> proteinProbs();
+  Array<double> proteinProbs(const Model& m) const;
   void printProteinWeights() const;
   void getProteinProbsPercolator(
     std::vector<ProteinScoreHolder>& proteins,
     std::map<std::string, size_t>& proteinToIdxMap) const;
   void getProteinProbsAndNames(std::vector<std::vector<std::string> > &names, std::vector<double> &probs) const;
+  void getProteinProbsAndNames(const Model& m, std::vector<std::vector<std::string> > &names, std::vector<double> &probs) const;
   void getProteinNames(std::vector<std::vector<std::string> > &names) const;
   void getProteinProbs();
   Array<string> peptideNames() const;
@@ -94,6 +96,8 @@ class GroupPowerBigraph {
 private:
   void initialize(BasicBigraph& basicBigraph);
   void getGroupProtNames();
+  std::vector<int> subgraphsBySize() const;
+  void getProteinProbsAndNames(const Array<double>& probsPresent, std::vector<std::vector<std::string> > &names, std::vector<double> &probs) const;
   
   Array<BasicBigraph> iterativePartitionSubgraphs(BasicBigraph & bb, double newPeptideThreshold );
   
@@ -4,56 +4,84 @@
 template <typename D>
 bool HashTable<D>::add(const D & data)
 {
-  // add the entry to the table
-  int index = hash(data);
-
-  if (! table[index].empty() )
+  if ( 2 * (numberOfElements + 1) > (int)table.size() )
     {
-      // this is just a performance check
-      // cerr << "Warning: collision" << endl;
+      grow();
     }
 
-  itemsByNumber.add(data);
-
-  if ( searchList( table[index], data ) != -1 )
+  int slot = findSlot(data);
+  if ( table[slot] != -1 )
     {
       return false;
     }
 
-  table[ index ].push_back( Node(data, numElements() ));
+  table[slot] = numberOfElements;
+  itemsByNumber.add(data);
   numberOfElements++;
 
   return true;
 }
 
+template <typename D>
+int HashTable<D>::insert(const D & data)
+{
+  if ( 2 * (numberOfElements + 1) > (int)table.size() )
+    {
+      grow();
+    }
+
+  int slot = findSlot(data);
+  if ( table[slot] == -1 )
+    {
+      table[slot] = numberOfElements;
+      itemsByNumber.add(data);
+      numberOfElements++;
+    }
+
+  return table[slot];
+}
+
 template <typename D>
 int HashTable<D>::lookup(const D & data) const
 {
-  int index = hash(data);
-  
-  return searchList( table[index], data );
+  return table[ findSlot(data) ];
 }
 
 template <typename D>
-int HashTable<D>::searchList(const list<Node> & li, const D & data) const
+int HashTable<D>::findSlot(const D & data) const
 {
-  typename list<Node >::const_iterator iter;
+  unsigned int mask = table.size() - 1;
+  unsigned int slot = hash(data);
+  while ( table[slot] != -1 && ! (itemsByNumber[ table[slot] ] == data) )
+    {
+      slot = (slot + 1) & mask;
+    }
+  return slot;
+}
 
-  for (iter = li.begin(); iter != li.end(); iter++)
+template <typename D>
+void HashTable<D>::grow()
+{
+  table.assign(2 * table.size(), -1);
+  unsigned int mask = table.size() - 1;
+  for (int k=0; k<numberOfElements; k++)
     {
-      if ( iter->data == data )
+      unsigned int slot = hash(itemsByNumber[k]);
+      while ( table[slot] != -1 )
 	{
-	  return iter->code;
+	  slot = (slot + 1) & mask;
 	}
+      table[slot] = k;
     }
-
-  return -1;
 }
 
 template <typename D>
 unsigned int HashTable<D>::hash(const D & data) const
 {
-  return defined_hash(data) % table.size();
+  // spread the user defined hash over the table with Fibonacci hashing,
+  // since the bits of the simple hash functions are poorly mixed
+  unsigned int h = defined_hash(data) * 2654435769u;
+  return (h ^ (h >> 16)) & (table.size() - 1);
 }
 
 template <typename D>
@@ -61,4 +89,3 @@ const D & HashTable<D>::getItem(int num)
 {
   return itemsByNumber[num];
 }
-
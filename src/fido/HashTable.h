@@ -1,11 +1,10 @@
 // Written by Oliver Serang 2009
 // see license for more information
 
-#ifndef _HASHTABLE_H
-#define _HASHTABLE_H
+#ifndef _FIDO_HASHTABLE_H
+#define _FIDO_HASHTABLE_H
 
 #include "Array.h"
-#include <list>
 #include <iostream>
 
 using namespace std;
@@ -14,22 +13,33 @@ using namespace std;
 
 #define default_size 1001
 
+/*
+* HashTable numbers the distinct items in the order they were added. It uses 
+*   open addressing with linear probing over a power-of-two table of item
+*   numbers, which is grown to keep the load factor below one half.
+*
+*/
 template <typename D>
 class HashTable
 {
  public:
 
  HashTable(unsigned int (*hashFunction) (const D & key), int size = default_size):
-  table(size)
+  numberOfElements(0)
   {
     defined_hash = hashFunction;
-    numberOfElements = 0;
+    int capacity = 16;
+    while (capacity < size)
+      capacity *= 2;
+    table.assign(capacity, -1);
   }
   virtual ~HashTable()
     {}
 
   // returns true if the element has been added, false if it is already there
   bool add(const D & data);
+  // adds the element if needed, and returns its number
+  int insert(const D & data);
   int lookup(const D & d) const;
   const D & getItem(int num);
 
@@ -50,29 +60,17 @@ class HashTable
 
  private:
 
-  struct Node
-  {
-    Node(const D & d, int uniq)
-    {
-      data = d;
-      code = uniq;
-    }
-    bool operator ==(const Node & rhs)
-    {
-      return data == rhs.data;
-    }
-    D data;
-    int code;
-  };
-
-  int searchList(const list<Node> & li, const D & data) const;
+  // returns the slot holding data, or the empty slot where it belongs
+  int findSlot(const D & data) const;
+  void grow();
 
   virtual unsigned int hash(const D & key) const;
   unsigned int (*defined_hash)(const D & d);
 
   int numberOfElements;
 
-  Array<list<Node> > table;
+  // item numbers, -1 for empty slots
+  vector<int> table;
   Array<D> itemsByNumber;
 };
 
@@ -55,7 +55,11 @@ class Model {
   // probability that @activeProts are present, given @totalProts
   double probabilityProteins(int totalProts, int activeProts) const {
     // using log for greater precision
-    return pow(2.0, Combinatorics::logBinomial(totalProts, activeProts) + activeProts*log2(gamma) + (totalProts-activeProts) * log2(1-gamma) );
+    return pow(2.0, logProbabilityProteins(totalProts, activeProts) );
+  }
+  
+  double logProbabilityProteins(int totalProts, int activeProts) const {
+    return Combinatorics::logBinomial(totalProts, activeProts) + activeProts*log2(gamma) + (totalProts-activeProts) * log2(1-gamma);
   }
 
   friend ostream & operator <<(ostream & os, const Model & m) {
@@ -12,6 +12,20 @@ void Set::add(int el) {
   Array<int>::add(el);
 }
 
+void Set::insert(int el) {
+  vector<int>::iterator iter = lower_bound(data.begin(), data.end(), el);
+  if (iter == data.end() || *iter != el) {
+    data.insert(iter, el);
+  }
+}
+
+void Set::erase(int el) {
+  vector<int>::iterator iter = lower_bound(data.begin(), data.end(), el);
+  if (iter != data.end() && *iter == el) {
+    data.erase(iter);
+  }
+}
+
 const Set& Set::operator &=(const Set & rhs) {
   Set result = (*this) & rhs;
   return *this = result;
@@ -91,6 +105,21 @@ Set Set::reindexToFind(const Set& base) {
   return C;
 }
 
+Set Set::reindexBy(const Array<int> & newIndex) const {
+  //  C == A.reindexBy(I) iff 
+  //  C[k] == I[ A[k] ], where I is increasing over the elements of A
+  Set C;
+  for (Set::Iterator iter = begin(); iter != end(); iter++) {
+    int loc = newIndex[ *iter ];
+    if ( loc == -1 ) {
+      cerr << "skipped in reindex-- set size is " << size() << endl;
+      throw InvalidBaseException();
+    }
+    C.add(loc);
+  }
+  return C;
+}
+
 const Set & Set::operator |=(const Set & rhs) {
   Set result = (*this) | rhs;
   return *this = result;
@@ -12,6 +12,9 @@ class Set : public Array<int> {
   Set() {}
 
   void add(int el);
+  // in place insertion and removal that keep the set sorted
+  void insert(int el);
+  void erase(int el);
   const Set & operator &=(const Set & rhs); // intersection
   const Set & operator |=(const Set & rhs); // union
   bool isEmpty() const { return size() == 0; }
@@ -21,6 +24,7 @@ class Set : public Array<int> {
 
   Set reindexTo(const Set & rhs);
   Set reindexToFind(const Set & rhs);
+  Set reindexBy(const Array<int> & newIndex) const;
 
   class UnsortedOrderException {};
   class InvalidBaseException {};
@@ -15,11 +15,13 @@
 #include <fcntl.h>
 #ifndef _MSC_VER
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <errno.h>
 #endif
 #include "Database.h"
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <iostream>
@@ -99,6 +101,11 @@ const string Database::binary_suffix = "-binary-fasta";
 const string Database::decoy_binary_suffix = "-binary-fasta-decoy";
 const string Database::decoy_fasta_suffix = "-random.fasta";
 
+// number of bytes of the fasta file that a thread scans for records at a time
+static const size_t FASTA_CHUNK_SIZE = 1 << 22;
+// minimum size of the memory blocks handed out by allocate
+static const size_t ARENA_BLOCK_SIZE = 1 << 16;
+
 /**
  * intializes a database object
  */
@@ -113,9 +120,9 @@ void Database::init(){
   file_size_ = 0;
   is_hashed_ = false;
   proteins_ = new vector<Protein*>();
-  protein_map_ = new map<char*, Protein*, cmp_str>();
   decoys_ = NO_DECOYS;
   binary_is_temp_ = false;
+  arena_left_ = 0;
 }
 
 /**
@@ -186,7 +193,6 @@ Database::~Database() {
       delete ((*proteins_)[protein_idx]);
     }
     delete proteins_;
-    delete protein_map_; // contents already deleted
     
     if (file_ != NULL) {
       // close file handle
@@ -194,6 +200,14 @@ Database::~Database() {
       fclose(file_);
     }
   }
+#ifndef _MSC_VER
+  if (data_address_ != NULL) {
+    munmap(data_address_, file_size_);
+  }
+#endif
+  for (size_t block = 0; block < arena_blocks_.size(); ++block) {
+    free(arena_blocks_[block]);
+  }
 }
 
 /**
@@ -220,8 +234,22 @@ void Database::addProtein(
   protein->setProteinIdx(proteins_->size()-1);
 
   if (is_hashed_) {
-    char* id = protein->getIdPointer();
-    protein_map_->insert(make_pair(id, protein));
+    indexProteinId(protein->getProteinIdx());
+  }
+}
+
+/**
+ * adds the id of the protein at protein_idx to the protein id index, unless
+ * an earlier protein has the same id
+ */
+void Database::indexProteinId(unsigned int protein_idx) {
+  const char* id = (*proteins_)[protein_idx]->getIdPointer();
+  if (id == NULL) {
+    return;
+  }
+  size_t num_ids = protein_index_.size();
+  if (protein_index_.intern(id, strlen(id)) == num_ids) {
+    protein_index_idxs_.push_back(protein_idx);
   }
 }
 
@@ -307,6 +335,157 @@ bool Database::parseTextFasta()
 }
 
 
+#ifndef _MSC_VER
+/**
+ * Parses a database from the text based fasta file in the filename
+ * member variable by privately memory mapping it. The record boundaries,
+ * '>' at the start of a line, are found in parallel chunks of the file and
+ * the proteins are parsed in place in parallel, such that their ids and
+ * sequences point into the mapped file instead of being copied.
+ * \returns true if success. false if failure.
+ */
+bool Database::parseMemmapFasta()
+{
+  if(is_parsed_){
+    return true;
+  }
+
+  int file_d = open(fasta_filename_.c_str(), O_RDONLY);
+  if(file_d < 0){
+    //carp(CARP_ERROR, "Failed to open fasta file %s", fasta_filename_.c_str());
+    return false;
+  }
+  struct stat file_info;
+  if(fstat(file_d, &file_info) != 0){
+    close(file_d);
+    return false;
+  }
+  size_t size = file_info.st_size;
+  if(size > 0){
+    // writable private mapping: parsing and reversing the proteins only
+    // changes our copy of the pages, never the file
+    void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         file_d, 0);
+    if(address == MAP_FAILED){
+      close(file_d);
+      return false;
+    }
+    data_address_ = address;
+    file_size_ = size;
+  }
+  close(file_d);
+  char* data = (char*)data_address_;
+
+  // as in parseTextFasta, the first '>' of each line starts a protein, also
+  // in the middle of a sequence line, except before the first line that
+  // starts with '>'
+  int num_chunks = (int)((size + FASTA_CHUNK_SIZE - 1) / FASTA_CHUNK_SIZE);
+  vector<vector<size_t> > chunk_starts(num_chunks);
+  #pragma omp parallel for schedule(dynamic, 1) if(num_chunks > 1)
+  for(int chunk = 0; chunk < num_chunks; ++chunk){
+    size_t pos = chunk * FASTA_CHUNK_SIZE;
+    size_t last = (std::min)(pos + FASTA_CHUNK_SIZE, size);
+    size_t line_start = pos;
+    while(line_start > 0 && data[line_start - 1] != '\n'){
+      --line_start;
+    }
+    bool in_title = memchr(data + line_start, '>', pos - line_start) != NULL;
+    while(pos < last){
+      if(!in_title){
+        char* found = (char*)memchr(data + pos, '>', last - pos);
+        if(found == NULL){
+          break;
+        }
+        pos = found - data;
+        chunk_starts[chunk].push_back(pos);
+      }
+      char* line_end = (char*)memchr(data + pos, '\n', size - pos);
+      if(line_end == NULL){
+        break;
+      }
+      pos = line_end - data + 1;
+      in_title = false;
+    }
+  }
+  vector<size_t> record_starts;
+  for(int chunk = 0; chunk < num_chunks; ++chunk){
+    vector<size_t>::iterator start = chunk_starts[chunk].begin();
+    if(record_starts.empty()){
+      while(start != chunk_starts[chunk].end() && 
+            *start > 0 && data[*start - 1] != '\n'){
+        ++start;
+      }
+    }
+    record_starts.insert(record_starts.end(), start, 
+                         chunk_starts[chunk].end());
+  }
+  int num_records = (int)record_starts.size();
+  record_starts.push_back(size);
+
+  // each record is followed by the '>' of the next one, which the parsing
+  // may overwrite. The last record ends before the final line break, or is
+  // parsed from a copy if the file does not end with one.
+  vector<char*> records(num_records), record_ends(num_records);
+  for(int record_idx = 0; record_idx < num_records; ++record_idx){
+    records[record_idx] = data + record_starts[record_idx];
+    record_ends[record_idx] = data + record_starts[record_idx + 1];
+  }
+  if(num_records > 0){
+    if(data[size - 1] == '\n'){
+      --record_ends.back();
+    } else {
+      size_t length = record_ends.back() - records.back();
+      char* copy = allocate(length + 1);
+      memcpy(copy, records.back(), length);
+      records.back() = copy;
+      record_ends.back() = copy + length;
+    }
+  }
+
+  proteins_->reserve(num_records);
+  for(int record_idx = 0; record_idx < num_records; ++record_idx){
+    Protein* new_protein = new Protein();
+    new_protein->setOffset(record_starts[record_idx]);
+    new_protein->setIsLight(false);
+    proteins_->push_back(new_protein);
+    new_protein->setProteinIdx(proteins_->size()-1);
+    new_protein->setDatabase(this);
+  }
+
+  #pragma omp parallel for schedule(dynamic, 1024) if(num_records > 1024)
+  for(int record_idx = 0; record_idx < num_records; ++record_idx){
+    (*proteins_)[record_idx]->parseProteinFastaMemmap(records[record_idx], 
+                                                      record_ends[record_idx]);
+  }
+
+  is_parsed_ = true;
+  return true;
+}
+#endif
+
+/**
+ * \returns size bytes of memory that is owned by the database, for
+ * strings of memory mapped proteins
+ */
+char* Database::allocate(
+  size_t size ///< number of bytes -in
+  )
+{
+  char* memory;
+  #pragma omp critical (database_arena)
+  {
+    if(size > arena_left_){
+      size_t block_size = (std::max)(size, ARENA_BLOCK_SIZE);
+      arena_blocks_.push_back((char*)malloc(block_size));
+      arena_left_ = block_size;
+    }
+    // hand out the memory from the end of the last block
+    arena_left_ -= size;
+    memory = arena_blocks_.back() + arena_left_;
+  }
+  return memory;
+}
+
 /**
  * Parses a database from the file in the filename member variable
  * The is_memmap field in the database struct determines whether the
@@ -327,6 +506,11 @@ bool Database::parseTextFasta()
  */
 bool Database::parse()
 {
+#ifndef _MSC_VER
+  if(!use_light_protein_){
+    return parseMemmapFasta();
+  }
+#endif
   return parseTextFasta();
 }
 
@@ -410,34 +594,34 @@ Protein* Database::getProteinByIdString(
   const char* protein_id ///< The id string for this protein -in
   ) {
 
-  //TODO - Implement as a hashtable rather than a map to make 
-  //this even faster if needed.
-  Protein* protein = NULL;
-  if (is_hashed_) {
-    map<char*, Protein*, cmp_str>::iterator find_iter;
-    find_iter = protein_map_->find((char*)protein_id);
+  return getProteinByIdString(protein_id, strlen(protein_id));
+}
 
-    if (find_iter != protein_map_->end()) {
-      protein = find_iter->second;
-    }
-  } else {
+/**
+ *\returns the protein designated by the protein id of the given length,
+ * or NULL if there is none
+ */
+Protein* Database::getProteinByIdString(
+  const char* protein_id, ///< The id string for this protein -in
+  size_t length ///< The length of the id string -in
+  ) {
+
+  if (!is_hashed_) {
     //create the hashtable of protein ids
+    protein_index_.reserve(proteins_->size());
+    protein_index_idxs_.reserve(proteins_->size());
     for (unsigned int protein_idx = 0;
       protein_idx < proteins_->size();
       protein_idx++) {
-
-      Protein* current_protein = proteins_->at(protein_idx);
-      char* current_id = current_protein->getIdPointer();
-      protein_map_->insert(make_pair(current_id, current_protein));
-
-      if (strcmp(current_id, protein_id)==0) {
-        protein = current_protein;
-      }
-        
+      indexProteinId(protein_idx);
     }
     is_hashed_ = true;
   }
-  return protein;
+  int id_idx = protein_index_.find(protein_id, length);
+  if (id_idx == StringInterner::kNotFound) {
+    return NULL;
+  }
+  return (*proteins_)[protein_index_idxs_[id_idx]];
 }
 
 /**
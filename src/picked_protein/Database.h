@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include "objects.h"
 #include "Protein.h"
+#include "StringInterner.h"
 #include <string>
 #include <cstring>
 #include <map>
@@ -29,14 +30,6 @@ namespace PercolatorCrux {
 int getline(char **lineptr, size_t *n, FILE *stream);
 #endif
 
-//Comparator function for c type strings.
-struct cmp_str {
-
-  bool operator()(char const *a, char const *b) const {
-    return strcmp(a, b) < 0;
-  }
-};
-
 class Database {
  protected:
   std::string fasta_filename_; ///< Name of the text file.
@@ -45,16 +38,19 @@ class Database {
                          ///  A database has only one associated file.
   bool is_parsed_;  ///< Has this database been parsed yet.
   std::vector<PercolatorCrux::Protein*>* proteins_; ///< Proteins in this database.
-  std::map<char*, PercolatorCrux::Protein*, cmp_str>* protein_map_; //map for proteins 
+  StringInterner protein_index_; ///< protein ids, indexed in the order of proteins_
+  std::vector<unsigned int> protein_index_idxs_; ///< protein index of each id in protein_index_
   bool is_hashed_; //Indicator of whether the database has been hashed/mapped.
   unsigned long int size_; ///< The size of the database in bytes (convenience)
   bool use_light_protein_; ///< should I use the light/heavy protein option
   bool is_memmap_; ///< Are we using a memory mapped fasta file? 
   void* data_address_; ///< pointer to the beginning of the memory mapped data, 
   unsigned int pointer_count_; ///< number of pointers referencing this database. 
-  long file_size_; ///< the size of the binary fasta file, when memory mapping
+  long file_size_; ///< the size of the memory mapped file
   DECOY_TYPE_T decoys_; ///< the type of decoys, none if target db
   bool binary_is_temp_; ///< should we delete the binary fasta in destructor
+  std::vector<char*> arena_blocks_; ///< memory blocks handed out by allocate
+  size_t arena_left_; ///< unused bytes in the last arena block
 
   /**
    * Parses a database from the text based fasta file in the filename
@@ -67,6 +63,15 @@ class Database {
    */
   bool parseTextFasta();
 
+  /**
+   * Parses a database from the text based fasta file in the filename
+   * member variable by privately memory mapping it. The record boundaries
+   * are found in parallel and each protein is parsed in place, such that
+   * the ids and sequences of the proteins point into the mapped file.
+   * \returns true if success. false if failure.
+   */
+  bool parseMemmapFasta();
+
   /**
    * memory maps the binary fasta file for the database
    *\return true if successfully memory map binary fasta file, else false
@@ -97,6 +102,13 @@ class Database {
    */
   void init();
 
+  /**
+   * adds the id of the protein at protein_idx to protein_index_
+   */
+  void indexProteinId(
+    unsigned int protein_idx ///< The index of the protein -in
+    );
+
  public:
   /**
    * The suffix on binary and text fasta files.
@@ -260,6 +272,15 @@ class Database {
     const char* protein_id ///< The id string for this protein -in
     );
 
+  /**
+   *\returns the protein designated by the protein id of the given length,
+   * which does not have to be null terminated, or NULL if there is none
+   */
+  PercolatorCrux::Protein* getProteinByIdString(
+    const char* protein_id, ///< The id string for this protein -in
+    size_t length ///< The length of the id string -in
+    );
+
   /**
    * sets the use_light_protein of the database
    */
@@ -279,6 +300,14 @@ class Database {
     bool is_memmap  ///< is the database memory mapped?
     );
 
+  /**
+   * \returns size bytes of memory that is owned by the database, for
+   * strings of memory mapped proteins
+   */
+  char* allocate(
+    size_t size ///< number of bytes -in
+    );
+
   /**
    * increase the pointer_count produced by this database.
    * \returns database pointer
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#include <algorithm>
+
+#include "GeneralizedSuffixArray.h"
+
+// the text ends with a unique smallest character, so that sorting its cyclic
+// shifts sorts its suffixes; the sequences are separated by the second
+// smallest character, which no sequence contains
+static const char kTerminator = '\0';
+static const char kSeparator = '\1';
+
+void GeneralizedSuffixArray::addSequence(const char* sequence, size_t length) {
+  starts_.push_back(text_.size());
+  lengths_.push_back(length);
+  text_.append(sequence, length);
+  text_.push_back(kSeparator);
+}
+
+/**
+ * Builds the suffix array by prefix doubling with counting sorts,
+ * O(n log n), and the longest common prefix array with Kasai's algorithm,
+ * O(n).
+ */
+void GeneralizedSuffixArray::build() {
+  text_.push_back(kTerminator);
+  int n = static_cast<int>(text_.size());
+  suffixes_.resize(n);
+  std::vector<int> classes(n), newSuffixes(n), newClasses(n);
+  std::vector<int> counts((std::max)(256, n), 0);
+
+  for (int i = 0; i < n; ++i) {
+    ++counts[static_cast<unsigned char>(text_[i])];
+  }
+  for (int c = 1; c < 256; ++c) {
+    counts[c] += counts[c - 1];
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    suffixes_[--counts[static_cast<unsigned char>(text_[i])]] = i;
+  }
+  int numClasses = 1;
+  classes[suffixes_[0]] = 0;
+  for (int i = 1; i < n; ++i) {
+    if (text_[suffixes_[i]] != text_[suffixes_[i - 1]]) ++numClasses;
+    classes[suffixes_[i]] = numClasses - 1;
+  }
+
+  // sort the cyclic shifts of length 2h by their two halves of length h
+  for (int h = 1; h < n && numClasses < n; h <<= 1) {
+    for (int i = 0; i < n; ++i) {
+      newSuffixes[i] = suffixes_[i] - h;
+      if (newSuffixes[i] < 0) newSuffixes[i] += n;
+    }
+    std::fill(counts.begin(), counts.begin() + numClasses, 0);
+    for (int i = 0; i < n; ++i) {
+      ++counts[classes[newSuffixes[i]]];
+    }
+    for (int c = 1; c < numClasses; ++c) {
+      counts[c] += counts[c - 1];
+    }
+    for (int i = n - 1; i >= 0; --i) {
+      suffixes_[--counts[classes[newSuffixes[i]]]] = newSuffixes[i];
+    }
+    numClasses = 1;
+    newClasses[suffixes_[0]] = 0;
+    for (int i = 1; i < n; ++i) {
+      int cur = suffixes_[i], prev = suffixes_[i - 1];
+      if (classes[cur] != classes[prev] ||
+          classes[(cur + h) % n] != classes[(prev + h) % n]) {
+        ++numClasses;
+      }
+      newClasses[cur] = numClasses - 1;
+    }
+    classes.swap(newClasses);
+  }
+
+  ranks_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    ranks_[suffixes_[i]] = i;
+  }
+  lcp_.assign(n, 0);
+  int h = 0;
+  for (int i = 0; i < n; ++i) {
+    if (ranks_[i] > 0) {
+      int j = suffixes_[ranks_[i] - 1];
+      while (text_[i + h] == text_[j + h] && text_[i + h] != kTerminator) ++h;
+      lcp_[ranks_[i]] = h;
+      if (h > 0) --h;
+    } else {
+      h = 0;
+    }
+  }
+}
+
+size_t GeneralizedSuffixArray::sequenceAt(size_t pos) const {
+  return std::upper_bound(starts_.begin(), starts_.end(), pos) - starts_.begin() - 1;
+}
+
+void GeneralizedSuffixArray::findSuperstrings(size_t seq_idx,
+    std::vector<size_t>& seq_idxs) const {
+  // the suffixes that start with the sequence are the neighbours of the
+  // suffix at its start that share at least its length as prefix
+  int length = static_cast<int>(lengths_[seq_idx]);
+  int first = ranks_[starts_[seq_idx]];
+  int last = first;
+  while (first > 0 && lcp_[first] >= length) --first;
+  while (last + 1 < static_cast<int>(lcp_.size()) && lcp_[last + 1] >= length) {
+    ++last;
+  }
+  seq_idxs.clear();
+  for (int r = first; r <= last; ++r) {
+    seq_idxs.push_back(sequenceAt(suffixes_[r]));
+  }
+  std::sort(seq_idxs.begin(), seq_idxs.end());
+  seq_idxs.erase(std::unique(seq_idxs.begin(), seq_idxs.end()), seq_idxs.end());
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+/*
+ * This file stores the class GeneralizedSuffixArray which finds the
+ * sequences of a set that contain another sequence of the set
+ */
+
+#ifndef PICKED_PROTEIN_GENERALIZED_SUFFIX_ARRAY_H_
+#define PICKED_PROTEIN_GENERALIZED_SUFFIX_ARRAY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+* GeneralizedSuffixArray is the suffix array, with its longest common prefix
+*   array, of a set of sequences joined by separators. All sequences that
+*   contain a sequence of the set lie in one interval of the suffix array,
+*   which is found from the suffix at the start of that sequence.
+*
+*/
+class GeneralizedSuffixArray {
+ public:
+  void addSequence(const char* sequence, size_t length);
+  void build();
+
+  // fills seq_idxs with the indices of the sequences that contain sequence
+  // seq_idx as a substring, including seq_idx itself, in ascending order
+  void findSuperstrings(size_t seq_idx, std::vector<size_t>& seq_idxs) const;
+
+  size_t getNumSequences() const { return starts_.size(); }
+
+ private:
+  std::string text_;
+  std::vector<size_t> starts_, lengths_;
+  std::vector<int> suffixes_; // text positions in lexicographic order
+  std::vector<int> ranks_; // inverse of suffixes_
+  std::vector<int> lcp_; // common prefix length of a suffix and its predecessor
+
+  size_t sequenceAt(size_t pos) const;
+};
+
+#endif /* PICKED_PROTEIN_GENERALIZED_SUFFIX_ARRAY_H_ */
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+#include <string.h>
+#include <algorithm>
+
+#include "PeptideProteinIndex.h"
+#include "StringHash.h"
+
+// below this number of entries a comparison sort beats the radix passes
+static const size_t kMinRadixSortSize = 1024;
+
+/**
+ * The finalizer in hashString also spreads the low bits, which the radix
+ * sort starts on
+ */
+uint64_t PeptideProteinIndex::hashSequence(const char* sequence,
+                                           unsigned int length) {
+  return hashString(sequence, length);
+}
+
+PeptideProteinIndex::Entry PeptideProteinIndex::makeEntry(
+    const char* sequence, unsigned int length, size_t protein_idx) {
+  Entry entry;
+  entry.hash = hashSequence(sequence, length);
+  entry.sequence = sequence;
+  entry.length = length;
+  entry.protein_idx = protein_idx;
+  return entry;
+}
+
+bool PeptideProteinIndex::sameSequence(const Entry& a, const Entry& b) {
+  return a.length == b.length && (a.sequence == b.sequence ||
+      memcmp(a.sequence, b.sequence, a.length) == 0);
+}
+
+bool PeptideProteinIndex::sequenceLess(const Entry& a, const Entry& b) {
+  int cmp = memcmp(a.sequence, b.sequence, (std::min)(a.length, b.length));
+  return cmp < 0 || (cmp == 0 && a.length < b.length);
+}
+
+static bool entryHashLess(const PeptideProteinIndex::Entry& a,
+                          const PeptideProteinIndex::Entry& b) {
+  return a.hash < b.hash;
+}
+
+/**
+ * Stable LSD radix sort on the hashes, one byte per pass. Passes in which
+ * all entries share the same byte are skipped.
+ */
+void PeptideProteinIndex::radixSort(std::vector<Entry>& entries) {
+  size_t n = entries.size();
+  if (n < kMinRadixSortSize) {
+    std::stable_sort(entries.begin(), entries.end(), entryHashLess);
+    return;
+  }
+  std::vector<Entry> buffer(n);
+  for (unsigned int shift = 0; shift < 64; shift += 8) {
+    size_t offsets[256] = { 0 };
+    std::vector<Entry>::const_iterator it = entries.begin();
+    for (; it != entries.end(); ++it) {
+      ++offsets[(it->hash >> shift) & 0xff];
+    }
+    if (offsets[(entries[0].hash >> shift) & 0xff] == n) continue;
+    size_t sum = 0;
+    for (int bucket = 0; bucket < 256; ++bucket) {
+      size_t count = offsets[bucket];
+      offsets[bucket] = sum;
+      sum += count;
+    }
+    for (it = entries.begin(); it != entries.end(); ++it) {
+      buffer[offsets[(it->hash >> shift) & 0xff]++] = *it;
+    }
+    entries.swap(buffer);
+  }
+}
+
+void PeptideProteinIndex::build(std::vector<std::vector<Entry> >& entries) {
+  size_t numEntries = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    numEntries += entries[i].size();
+  }
+  std::vector<Entry> sorted;
+  sorted.reserve(numEntries);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    sorted.insert(sorted.end(), entries[i].begin(), entries[i].end());
+    std::vector<Entry>().swap(entries[i]);
+  }
+  radixSort(sorted);
+
+  peptides_.clear();
+  proteins_.clear();
+  proteins_.reserve(numEntries);
+  size_t runStart = 0;
+  while (runStart < sorted.size()) {
+    // verify that all entries with this hash have the same sequence, and
+    // group them by sequence otherwise
+    size_t runEnd = runStart + 1;
+    bool isCollision = false;
+    while (runEnd < sorted.size() && sorted[runEnd].hash == sorted[runStart].hash) {
+      if (!sameSequence(sorted[runStart], sorted[runEnd])) isCollision = true;
+      ++runEnd;
+    }
+    if (isCollision) {
+      std::stable_sort(sorted.begin() + runStart, sorted.begin() + runEnd,
+                       sequenceLess);
+    }
+    for (size_t k = runStart; k < runEnd; ++k) {
+      if (k == runStart || (isCollision && !sameSequence(sorted[k - 1], sorted[k]))) {
+        Peptide peptide;
+        peptide.hash = sorted[k].hash;
+        peptide.sequence = sorted[k].sequence;
+        peptide.length = sorted[k].length;
+        peptide.first_protein = proteins_.size();
+        peptides_.push_back(peptide);
+      }
+      proteins_.push_back(sorted[k].protein_idx);
+    }
+    runStart = runEnd;
+  }
+}
+
+std::pair<PeptideProteinIndex::ProteinIterator,
+          PeptideProteinIndex::ProteinIterator>
+    PeptideProteinIndex::getProteins(const char* sequence,
+                                     unsigned int length) const {
+  uint64_t hash = hashSequence(sequence, length);
+  std::vector<Peptide>::const_iterator it = std::lower_bound(
+      peptides_.begin(), peptides_.end(), hash, hashLess);
+  for (; it != peptides_.end() && it->hash == hash; ++it) {
+    if (it->length == length && memcmp(it->sequence, sequence, length) == 0) {
+      size_t peptide_idx = it - peptides_.begin();
+      return std::make_pair(proteins_.begin() + it->first_protein,
+                            proteins_.begin() + lastProtein(peptide_idx));
+    }
+  }
+  return std::make_pair(proteins_.end(), proteins_.end());
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ Copyright 2006-2012 Lukas Käll <lukas.kall@scilifelab.se>
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ *******************************************************************************/
+/*
+ * This file stores the class PeptideProteinIndex which maps digested peptide
+ * sequences to the indices of the proteins they occur in
+ */
+
+#ifndef PICKED_PROTEIN_PEPTIDE_PROTEIN_INDEX_H_
+#define PICKED_PROTEIN_PEPTIDE_PROTEIN_INDEX_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+* PeptideProteinIndex groups the proteins of a digest by the 64-bit hash of
+*   their peptides. The peptide sequences are not copied but point into the
+*   protein sequences, which therefore have to outlive the index. Peptides
+*   with colliding hashes are told apart by comparing their sequences.
+*
+*/
+class PeptideProteinIndex {
+ public:
+  // a peptide occurrence in a protein, as emitted by the digestion
+  struct Entry {
+    uint64_t hash;
+    const char* sequence;
+    unsigned int length;
+    size_t protein_idx;
+  };
+
+  typedef std::vector<size_t>::const_iterator ProteinIterator;
+
+  static uint64_t hashSequence(const char* sequence, unsigned int length);
+  static Entry makeEntry(const char* sequence, unsigned int length,
+                         size_t protein_idx);
+
+  // builds the index from the digests of consecutive protein ranges; the
+  // protein indices of each peptide keep the order in which they were
+  // emitted. The entry vectors are emptied.
+  void build(std::vector<std::vector<Entry> >& entries);
+
+  // the proteins containing the peptide, an empty range if there are none
+  std::pair<ProteinIterator, ProteinIterator> getProteins(
+      const char* sequence, unsigned int length) const;
+
+  size_t getNumPeptides() const { return peptides_.size(); }
+
+ private:
+  struct Peptide {
+    uint64_t hash;
+    const char* sequence;
+    unsigned int length;
+    size_t first_protein;
+  };
+
+  std::vector<Peptide> peptides_; // sorted by hash
+  std::vector<size_t> proteins_; // protein indices, grouped by peptide
+
+  static void radixSort(std::vector<Entry>& entries);
+  static bool sameSequence(const Entry& a, const Entry& b);
+  static bool sequenceLess(const Entry& a, const Entry& b);
+  static bool hashLess(const Peptide& peptide, uint64_t hash) {
+    return peptide.hash < hash;
+  }
+  size_t lastProtein(size_t peptide_idx) const {
+    return (peptide_idx + 1 < peptides_.size()) ?
+        peptides_[peptide_idx + 1].first_protein : proteins_.size();
+  }
+};
+
+#endif /* PICKED_PROTEIN_PEPTIDE_PROTEIN_INDEX_H_ */
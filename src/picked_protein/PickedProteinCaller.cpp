@@ -15,7 +15,18 @@
 
  *******************************************************************************/
 
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
 #include "PickedProteinCaller.h"
+#include "StringHash.h"
 #include "Version.h"
 #include "Option.h"
 #include "Globals.h"
@@ -94,45 +105,101 @@ bool PickedProteinCaller::parseOptions(int argc, char** argv) {
   return true;
 }
 
-void PickedProteinCaller::addToPeptideProteinMap(Database& db, 
-    size_t protein_idx, PeptideConstraint& peptide_constraint,
-    std::map<std::string, std::vector<size_t> >& peptide_protein_map,
+// number of proteins that a thread digests at a time
+static const size_t kProteinsPerChunk = 1024;
+
+//!
+//! digests the proteins in \p protein_idxs and fills \p peptide_protein_index
+//! with the proteins that each peptide occurs in. The proteins are digested
+//! in parallel chunks, the order of the protein indices of a peptide is the
+//! order of \p protein_idxs.
+//!
+void PickedProteinCaller::digestProteins(Database& db, 
+    const std::vector<size_t>& protein_idxs,
+    PeptideConstraint& peptide_constraint,
+    PeptideProteinIndex& peptide_protein_index,
     std::map<size_t, size_t>& num_peptides_per_protein,
     bool reverseProteinSeqs) {
-  PercolatorCrux::Protein* protein = db.getProteinAtIdx(protein_idx);
-  
-  if (reverseProteinSeqs) {
-    protein->shuffle(PROTEIN_REVERSE_DECOYS);
-    
-    // MT: the crux interface will change the protein identifier. If we are
-    // not inside the crux environment we do this separately here.
-    std::string currentId(protein->getIdPointer());
-    if (currentId.substr(0, decoyPattern_.size()) != decoyPattern_) {
-      currentId = decoyPattern_ + currentId;
-      protein->setId(currentId.c_str());
+  int numChunks = static_cast<int>(
+      (protein_idxs.size() + kProteinsPerChunk - 1) / kProteinsPerChunk);
+  std::vector<std::vector<PeptideProteinIndex::Entry> > peptides(numChunks);
+  std::vector<size_t> numPeptides(protein_idxs.size());
+  bool has_decoys = false;
+  #pragma omp parallel for schedule(dynamic, 1) if(numChunks > 1)
+  for (int chunk = 0; chunk < numChunks; ++chunk) {
+    // the peptide iterators change the reference count of their constraint,
+    // so each chunk gets its own copy
+    PeptideConstraint chunk_constraint(peptide_constraint.getEnzyme(), 
+        peptide_constraint.getDigest(), peptide_constraint.getMinLength(), 
+        peptide_constraint.getMaxLength(), 
+        peptide_constraint.getNumMisCleavage());
+    bool chunk_has_decoys = false;
+    size_t last = (std::min)((chunk + 1) * kProteinsPerChunk, protein_idxs.size());
+    for (size_t k = chunk * kProteinsPerChunk; k < last; ++k) {
+      PercolatorCrux::Protein* protein = db.getProteinAtIdx(protein_idxs[k]);
+      if (reverseProteinSeqs) {
+        protein->shuffle(PROTEIN_REVERSE_DECOYS);
+        
+        // MT: the crux interface will change the protein identifier. If we are
+        // not inside the crux environment we do this separately here.
+        std::string currentId(protein->getIdPointer());
+        if (currentId.substr(0, decoyPattern_.size()) != decoyPattern_) {
+          currentId = decoyPattern_ + currentId;
+          protein->setId(currentId.c_str());
+        }
+      } else if (!chunk_has_decoys) {
+        std::string currentId(protein->getIdPointer());
+        if (currentId.substr(0, decoyPattern_.size()) == decoyPattern_) {
+          chunk_has_decoys = true;
+        }
+      }
+      numPeptides[k] = digestProtein(protein, protein_idxs[k], 
+                                     chunk_constraint, peptides[chunk]);
     }
-  } else if (!fasta_has_decoys_) {
-    std::string currentId(protein->getIdPointer());
-    if (currentId.substr(0, decoyPattern_.size()) == decoyPattern_) {
-      fasta_has_decoys_ = true;
+    if (chunk_has_decoys) {
+#pragma omp critical (picked_protein_decoys)
+      has_decoys = true;
     }
   }
+  if (has_decoys) fasta_has_decoys_ = true;
   
+  peptide_protein_index.build(peptides);
+  for (size_t k = 0; k < protein_idxs.size(); ++k) {
+    num_peptides_per_protein[protein_idxs[k]] = numPeptides[k];
+  }
+}
+
+size_t PickedProteinCaller::digestProtein(PercolatorCrux::Protein* protein, 
+    size_t protein_idx, PeptideConstraint& peptide_constraint,
+    std::vector<PeptideProteinIndex::Entry>& peptides) {
   ProteinPeptideIterator cur_protein_peptide_iterator(protein, &peptide_constraint);
   size_t numPeptides = 0;
   while (cur_protein_peptide_iterator.hasNext()) {
     PercolatorCrux::Peptide* peptide = cur_protein_peptide_iterator.next();
-    std::string sequence(peptide->getSequencePointer(), peptide->getLength());
-    peptide_protein_map[sequence].push_back(protein_idx);
+    const char* sequence = peptide->getSequencePointer();
+    unsigned int length = peptide->getLength();
+    peptides.push_back(PeptideProteinIndex::makeEntry(sequence, length, protein_idx));
     if (sequence[0] == 'M' && peptide->getNTermFlankingAA() == '-'
-          && peptide->getLength() - 1 >= min_peptide_length_) {
-      std::string metCleavedSequence(sequence.substr(1, peptide->getLength() - 1));
-      peptide_protein_map[metCleavedSequence].push_back(protein_idx);
+          && length - 1 >= min_peptide_length_) {
+      peptides.push_back(PeptideProteinIndex::makeEntry(
+          sequence + 1, length - 1, protein_idx));
     }
     PercolatorCrux::Peptide::free(peptide);
     ++numPeptides;
   }
-  num_peptides_per_protein[protein_idx] = numPeptides;
+  return numPeptides;
+}
+
+static void intersectProteins(std::vector<size_t>& protein_idx_intersection,
+    std::pair<PeptideProteinIndex::ProteinIterator, 
+              PeptideProteinIndex::ProteinIterator> peptide_proteins,
+    std::vector<size_t>& buffer) {
+  buffer.resize(protein_idx_intersection.size());
+  std::vector<size_t>::iterator it = std::set_intersection(
+      protein_idx_intersection.begin(), protein_idx_intersection.end(), 
+      peptide_proteins.first, peptide_proteins.second, buffer.begin());
+  buffer.resize(it - buffer.begin());
+  protein_idx_intersection.swap(buffer);
 }
 
 //!
@@ -140,51 +207,81 @@ void PickedProteinCaller::addToPeptideProteinMap(Database& db,
 //! subset peptides 
 //! 
 //! @param[in] db fasta database representation
-//! @param[in] protein_idx protein index of protein to be digested
+//! @param[in] protein_idxs protein indices of the proteins to be digested
 //! @param[in] peptide_constraint digestion parameters
+//! @param[in] peptide_protein_index proteins of each peptide of the digest
 //! @param[in] num_peptides_per_protein helps to find out which proteins have 
 //!   identical sets and which ones are proper subsets.
 //! @param[out] fragment_protein_map groups of proteins with same or subset peptides
 //!
 void PickedProteinCaller::findFragmentProteins(Database& db, 
-    size_t protein_idx, PeptideConstraint& peptide_constraint,
-    std::map<std::string, std::vector<size_t> >& peptide_protein_map,
+    const std::vector<size_t>& protein_idxs,
+    PeptideConstraint& peptide_constraint,
+    const PeptideProteinIndex& peptide_protein_index,
     std::map<size_t, size_t>& num_peptides_per_protein,
     std::map<size_t, std::vector<size_t> >& fragment_protein_map) {
+  int numChunks = static_cast<int>(
+      (protein_idxs.size() + kProteinsPerChunk - 1) / kProteinsPerChunk);
+  std::vector<std::vector<size_t> > superset_proteins(protein_idxs.size());
+  #pragma omp parallel for schedule(dynamic, 1) if(numChunks > 1)
+  for (int chunk = 0; chunk < numChunks; ++chunk) {
+    PeptideConstraint chunk_constraint(peptide_constraint.getEnzyme(), 
+        peptide_constraint.getDigest(), peptide_constraint.getMinLength(), 
+        peptide_constraint.getMaxLength(), 
+        peptide_constraint.getNumMisCleavage());
+    size_t last = (std::min)((chunk + 1) * kProteinsPerChunk, protein_idxs.size());
+    for (size_t k = chunk * kProteinsPerChunk; k < last; ++k) {
+      if (!findSupersetProteins(db, protein_idxs[k], chunk_constraint, 
+              peptide_protein_index, superset_proteins[k])) {
+        std::vector<size_t>().swap(superset_proteins[k]);
+      }
+    }
+  }
+  
+  // the groups depend on the order in which the proteins are added
+  for (size_t k = 0; k < protein_idxs.size(); ++k) {
+    if (!superset_proteins[k].empty()) {
+      addToFragmentProteinMap(protein_idxs[k], superset_proteins[k], 
+          num_peptides_per_protein, fragment_protein_map);
+    }
+  }
+}
+
+//! finds all proteins of which the protein's peptides are a subset (possibly 
+//! identical), returns true if there are other proteins than itself
+bool PickedProteinCaller::findSupersetProteins(Database& db, 
+    size_t protein_idx, PeptideConstraint& peptide_constraint,
+    const PeptideProteinIndex& peptide_protein_index,
+    std::vector<size_t>& protein_idx_intersection) {
   PercolatorCrux::Protein* protein = db.getProteinAtIdx(protein_idx);
   
   ProteinPeptideIterator cur_protein_peptide_iterator(protein, &peptide_constraint);
   
-  // find all proteins of which the current protein's peptides are a subset (possibly identical)
   bool is_first = true;
-  std::vector<size_t> protein_idx_intersection;
+  std::vector<size_t> buffer;
+  protein_idx_intersection.clear();
   while (cur_protein_peptide_iterator.hasNext()) {
     PercolatorCrux::Peptide* peptide = cur_protein_peptide_iterator.next();
-    std::string sequence(peptide->getSequencePointer(), peptide->getLength());   
+    const char* sequence = peptide->getSequencePointer();
+    unsigned int length = peptide->getLength();
     
     if (is_first) {
-      protein_idx_intersection = peptide_protein_map[sequence]; // proteins sharing the first peptide
+      // proteins sharing the first peptide
+      std::pair<PeptideProteinIndex::ProteinIterator, 
+                PeptideProteinIndex::ProteinIterator> peptide_proteins = 
+          peptide_protein_index.getProteins(sequence, length);
+      protein_idx_intersection.assign(peptide_proteins.first, 
+                                      peptide_proteins.second);
       is_first = false;
     } else {
-      std::vector<size_t> newprotein_idx_intersection(protein_idx_intersection.size());
-      std::vector<size_t>::iterator it = std::set_intersection(
-          protein_idx_intersection.begin(), protein_idx_intersection.end(), 
-          peptide_protein_map[sequence].begin(), peptide_protein_map[sequence].end(), 
-          newprotein_idx_intersection.begin());
-      newprotein_idx_intersection.resize(it - newprotein_idx_intersection.begin());
-      protein_idx_intersection = newprotein_idx_intersection;
+      intersectProteins(protein_idx_intersection, 
+          peptide_protein_index.getProteins(sequence, length), buffer);
     }
     
     if (sequence[0] == 'M' && peptide->getNTermFlankingAA() == '-'
-          && peptide->getLength() - 1 >= min_peptide_length_) {
-      std::string metCleavedSequence(sequence.substr(1, peptide->getLength() - 1));
-      std::vector<size_t> newprotein_idx_intersection(protein_idx_intersection.size());
-      std::vector<size_t>::iterator it = std::set_intersection(
-          protein_idx_intersection.begin(), protein_idx_intersection.end(), 
-          peptide_protein_map[metCleavedSequence].begin(), peptide_protein_map[metCleavedSequence].end(), 
-          newprotein_idx_intersection.begin());
-      newprotein_idx_intersection.resize(it - newprotein_idx_intersection.begin());
-      protein_idx_intersection = newprotein_idx_intersection;
+          && length - 1 >= min_peptide_length_) {
+      intersectProteins(protein_idx_intersection, 
+          peptide_protein_index.getProteins(sequence + 1, length - 1), buffer);
     }
      
     PercolatorCrux::Peptide::free(peptide);
@@ -193,10 +290,7 @@ void PickedProteinCaller::findFragmentProteins(Database& db,
   
   // if there are still proteins left in the intersection, it means that the 
   // current protein is a subset of at least one another protein
-  if (protein_idx_intersection.size() > 1) {
-    addToFragmentProteinMap(protein_idx, protein_idx_intersection, 
-        num_peptides_per_protein, fragment_protein_map);
-  }
+  return protein_idx_intersection.size() > 1;
 }
   
 void PickedProteinCaller::addToFragmentProteinMap(
@@ -274,19 +368,15 @@ void PickedProteinCaller::findFragmentsAndDuplicatesExtraDigest(Database& db,
     }
     std::sort(it->second.begin(), it->second.end());
     
-    std::map<std::string, std::vector<size_t> > peptide_protein_map;
+    PeptideProteinIndex peptide_protein_index;
     std::map<size_t, size_t> num_peptides_per_protein_local;
-    for (std::vector<size_t>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
-      addToPeptideProteinMap(db, *it2, peptide_constraint, 
-          peptide_protein_map, num_peptides_per_protein_local, reverseProteinSeqs);
-    }
+    digestProteins(db, it->second, peptide_constraint, peptide_protein_index,
+        num_peptides_per_protein_local, reverseProteinSeqs);
     
     std::map<size_t, std::vector<size_t> > fragment_protein_map_local;
-    for (std::vector<size_t>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
-      findFragmentProteins(db, *it2, peptide_constraint, 
-          peptide_protein_map, num_peptides_per_protein_local, 
-          fragment_protein_map_local);
-    }
+    findFragmentProteins(db, it->second, peptide_constraint, 
+        peptide_protein_index, num_peptides_per_protein_local, 
+        fragment_protein_map_local);
     
     findFragmentsAndDuplicates(db, fragment_protein_map_local, 
         num_peptides_per_protein_local, fragment_map, duplicate_map);
@@ -306,30 +396,28 @@ void PickedProteinCaller::findFragmentsAndDuplicatesNonSpecificDigest(
     }
     std::sort(it->second.begin(), it->second.end());
     
-    std::vector<std::string> sequences;
+    GeneralizedSuffixArray suffix_array;
     std::map<size_t, size_t> num_peptides_per_protein_local;
     for (std::vector<size_t>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
       size_t protein_idx = *it2;
       PercolatorCrux::Protein* protein = db.getProteinAtIdx(protein_idx);
-      std::string sequence(protein->getSequencePointer(), protein->getLength());
-      sequences.push_back(sequence);
+      suffix_array.addSequence(protein->getSequencePointer(), protein->getLength());
       num_peptides_per_protein_local[protein_idx] = protein->getLength();
     }
+    suffix_array.build();
     
     // In a non-specific digest the only possibility for one protein to be subset
     // of another is if the entire string is contained (except for some very
     // unlikely cases where a region longer than max_len is repeated more than twice)
     std::map<size_t, std::vector<size_t> > fragment_protein_map_local;
-    std::vector<std::string>::iterator sit2 = sequences.begin();
-    for (std::vector<size_t>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2, ++sit2) {
-      size_t protein_idx = *it2;
+    std::vector<size_t> superstring_idxs;
+    for (size_t k = 0; k < it->second.size(); ++k) {
+      size_t protein_idx = it->second[k];
       
+      suffix_array.findSuperstrings(k, superstring_idxs);
       std::vector<size_t> protein_idx_intersection;
-      std::vector<size_t>::iterator it3 = it->second.begin();
-      for (std::vector<std::string>::iterator sit3 = sequences.begin(); sit3 != sequences.end(); ++sit3, ++it3) {
-        if (sit3->find(*sit2) != std::string::npos) {
-          protein_idx_intersection.push_back(*it3);
-        }
+      for (std::vector<size_t>::iterator it3 = superstring_idxs.begin(); it3 != superstring_idxs.end(); ++it3) {
+        protein_idx_intersection.push_back(it->second[*it3]);
       }
       
       if (protein_idx_intersection.size() > 1) {
@@ -375,13 +463,15 @@ bool PickedProteinCaller::getProteinFragmentsAndDuplicates(
   PeptideConstraint peptide_constraint(enzyme_, FULL_DIGEST, 
       min_peptide_length_, (std::min)(50, max_peptide_length_), 
       (std::min)(2, max_miscleavages_) );
-  std::map<std::string, std::vector<size_t> > peptide_protein_map;
-  std::map<size_t, size_t> num_peptides_per_protein;
-  for (size_t protein_idx = 0; protein_idx < db.getNumProteins(); 
+  std::vector<size_t> protein_idxs(db.getNumProteins());
+  for (size_t protein_idx = 0; protein_idx < protein_idxs.size(); 
        ++protein_idx) {
-    addToPeptideProteinMap(db, protein_idx, peptide_constraint, 
-        peptide_protein_map, num_peptides_per_protein, reverseProteinSeqs);
+    protein_idxs[protein_idx] = protein_idx;
   }
+  PeptideProteinIndex peptide_protein_index;
+  std::map<size_t, size_t> num_peptides_per_protein;
+  digestProteins(db, protein_idxs, peptide_constraint, peptide_protein_index,
+      num_peptides_per_protein, reverseProteinSeqs);
   
   if (VERB > 3) {
     reportProgress("Creating protein peptide map", startTime, startClock);
@@ -390,11 +480,8 @@ bool PickedProteinCaller::getProteinFragmentsAndDuplicates(
   // Find all proteins whose peptides form a subset (possibly identical) 
   // of another protein
   std::map<size_t, std::vector<size_t> > fragment_protein_map;
-  for (size_t protein_idx = 0; protein_idx < db.getNumProteins(); 
-       ++protein_idx) {
-    findFragmentProteins(db, protein_idx, peptide_constraint,
-        peptide_protein_map, num_peptides_per_protein, fragment_protein_map);
-  }
+  findFragmentProteins(db, protein_idxs, peptide_constraint,
+      peptide_protein_index, num_peptides_per_protein, fragment_protein_map);
   
   if (VERB > 3) {
     reportProgress("Creating fragment protein map", startTime, startClock);
@@ -426,6 +513,188 @@ bool PickedProteinCaller::getProteinFragmentsAndDuplicates(
   return EXIT_SUCCESS;
 }
 
+// identifies digest cache files, the version has to be increased whenever
+// the file layout or the fragment and duplicate detection change
+static const char kDigestCacheMagic[4] = { 'P', 'P', 'D', 'C' };
+static const uint32_t kDigestCacheVersion = 1;
+
+template <typename T>
+static void appendBinary(std::string& buffer, const T& value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void appendBinary(std::string& buffer, const std::string& value) {
+  appendBinary(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+template <typename T>
+static bool readBinary(const char*& pos, const char* end, T& value) {
+  if (static_cast<size_t>(end - pos) < sizeof(T)) return false;
+  memcpy(&value, pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+static bool readBinary(const char*& pos, const char* end, std::string& value) {
+  uint32_t length;
+  if (!readBinary(pos, end, length) || 
+      static_cast<size_t>(end - pos) < length) return false;
+  value.assign(pos, length);
+  pos += length;
+  return true;
+}
+
+static void appendMap(std::string& buffer, 
+                      const std::map<std::string, std::string>& protein_map) {
+  appendBinary(buffer, static_cast<uint64_t>(protein_map.size()));
+  std::map<std::string, std::string>::const_iterator it;
+  for (it = protein_map.begin(); it != protein_map.end(); ++it) {
+    appendBinary(buffer, it->first);
+    appendBinary(buffer, it->second);
+  }
+}
+
+static bool readMap(const char*& pos, const char* end,
+                    std::map<std::string, std::string>& protein_map) {
+  uint64_t numEntries;
+  if (!readBinary(pos, end, numEntries)) return false;
+  std::string key, value;
+  for (uint64_t i = 0; i < numEntries; ++i) {
+    if (!readBinary(pos, end, key) || !readBinary(pos, end, value)) {
+      return false;
+    }
+    // the entries were written in order
+    protein_map.insert(protein_map.end(), std::make_pair(key, value));
+  }
+  return true;
+}
+
+//! the header of the digest cache: the file format, a hash of the content
+//! of the fasta database and the parameters that the maps depend on
+bool PickedProteinCaller::getDigestCacheKey(std::string& key) {
+  if (digest_cache_key_.empty()) {
+    FILE* fasta = fopen(protein_db_file_.c_str(), "rb");
+    if (fasta == NULL) return false;
+    // 64-bit FNV-1a over words of 8 bytes
+    uint64_t hash = kFnvOffsetBasis;
+    std::vector<uint64_t> buffer(1 << 16);
+    size_t bytesRead;
+    while ((bytesRead = fread(&buffer[0], 1, buffer.size() * sizeof(uint64_t), 
+                              fasta)) > 0) {
+      size_t numWords = (bytesRead + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+      memset(reinterpret_cast<char*>(&buffer[0]) + bytesRead, 0, 
+             numWords * sizeof(uint64_t) - bytesRead);
+      for (size_t i = 0; i < numWords; ++i) {
+        hash ^= buffer[i];
+        hash *= kFnvPrime;
+      }
+      hash ^= bytesRead;
+    }
+    fclose(fasta);
+    
+    digest_cache_key_.append(kDigestCacheMagic, sizeof(kDigestCacheMagic));
+    appendBinary(digest_cache_key_, kDigestCacheVersion);
+    appendBinary(digest_cache_key_, hash);
+    appendBinary(digest_cache_key_, static_cast<int32_t>(enzyme_));
+    appendBinary(digest_cache_key_, static_cast<int32_t>(digestion_));
+    appendBinary(digest_cache_key_, static_cast<int32_t>(min_peptide_length_));
+    appendBinary(digest_cache_key_, static_cast<int32_t>(max_peptide_length_));
+    appendBinary(digest_cache_key_, static_cast<int32_t>(max_miscleavages_));
+    appendBinary(digest_cache_key_, decoyPattern_);
+  }
+  key = digest_cache_key_;
+  return true;
+}
+
+//! reads the fragment and duplicate maps from the digest cache, returns false
+//! if there is no cache for the current database and parameters
+bool PickedProteinCaller::readDigestCache(
+    std::map<std::string, std::string>& fragment_map,
+    std::map<std::string, std::string>& duplicate_map) {
+#ifdef _MSC_VER
+  return false;
+#else
+  std::string key;
+  std::string cacheFile = getDigestCacheFile();
+  int file_d = open(cacheFile.c_str(), O_RDONLY);
+  if (file_d < 0) return false;
+  struct stat file_info;
+  if (fstat(file_d, &file_info) != 0 || file_info.st_size == 0 || 
+      !getDigestCacheKey(key)) {
+    close(file_d);
+    return false;
+  }
+  size_t size = file_info.st_size;
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file_d, 0);
+  close(file_d);
+  if (data == MAP_FAILED) return false;
+  
+  const char* pos = static_cast<const char*>(data);
+  const char* end = pos + size;
+  std::map<std::string, std::string> fragments, duplicates;
+  bool success = size >= key.size() && memcmp(pos, key.data(), key.size()) == 0;
+  if (success) {
+    pos += key.size();
+    success = readMap(pos, end, fragments) && readMap(pos, end, duplicates) 
+                && pos == end;
+  }
+  munmap(data, size);
+  
+  if (success) {
+    fragment_map.insert(fragments.begin(), fragments.end());
+    duplicate_map.insert(duplicates.begin(), duplicates.end());
+  } else if (VERB > 1) {
+    std::cerr << "Digest cache " << cacheFile << " does not match the "
+              << "fasta database or digestion parameters, ignoring it." 
+              << std::endl;
+  }
+  return success;
+#endif
+}
+
+//! writes the fragment and duplicate maps to the digest cache, the file is 
+//! written under a temporary name unique to this process and write, and then
+//! renamed into place, so that concurrent runs never read a partial cache
+bool PickedProteinCaller::writeDigestCache(
+    const std::map<std::string, std::string>& fragment_map,
+    const std::map<std::string, std::string>& duplicate_map) {
+  std::string buffer;
+  if (!getDigestCacheKey(buffer)) return false;
+  appendMap(buffer, fragment_map);
+  appendMap(buffer, duplicate_map);
+  
+  std::string cacheFile = getDigestCacheFile();
+  static unsigned int numWrites = 0;
+  ostringstream tmpName;
+  tmpName << cacheFile << ".tmp." << getpid() << "." << numWrites++;
+  std::string tmpFile = tmpName.str();
+#ifndef _MSC_VER
+  int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+  FILE* out = (fd < 0) ? NULL : fdopen(fd, "wb");
+  if (out == NULL) {
+    if (fd >= 0) {
+      close(fd);
+      remove(tmpFile.c_str());
+    }
+    return false;
+  }
+#else
+  FILE* out = fopen(tmpFile.c_str(), "wb");
+  if (out == NULL) return false;
+#endif
+  bool success = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+  success = (fclose(out) == 0) && success;
+  if (success) {
+#ifdef _MSC_VER
+    remove(cacheFile.c_str()); // rename does not replace existing files
+#endif
+    success = (rename(tmpFile.c_str(), cacheFile.c_str()) == 0);
+  }
+  if (!success) remove(tmpFile.c_str());
+  return success;
+}
+
 void PickedProteinCaller::reportProgress(const std::string& msg,
     const time_t& startTime, const clock_t& startClock) {
   time_t procStart;
@@ -32,7 +32,9 @@
 #include <algorithm>
 
 #include "Database.h"
+#include "GeneralizedSuffixArray.h"
 #include "PeptideConstraint.h"
+#include "PeptideProteinIndex.h"
 #include "ProteinPeptideIterator.h"
 #include "Protein.h"
 
@@ -62,6 +64,16 @@ class PickedProteinCaller{
       std::map<std::string, std::string>& duplicate_map,
       bool reverseProteinSeqs);
   
+  // the digest cache stores the fragment and duplicate maps next to the
+  // fasta database, keyed by its content and the digestion parameters
+  std::string getDigestCacheFile() const { 
+    return protein_db_file_ + ".digest-cache"; 
+  }
+  bool readDigestCache(std::map<std::string, std::string>& fragment_map,
+                       std::map<std::string, std::string>& duplicate_map);
+  bool writeDigestCache(const std::map<std::string, std::string>& fragment_map,
+                        const std::map<std::string, std::string>& duplicate_map);
+  
  private:
   PercolatorCrux::ENZYME_T enzyme_;
   PercolatorCrux::DIGEST_T digestion_;
@@ -70,18 +82,30 @@ class PickedProteinCaller{
   bool fasta_has_decoys_;
   
   std::string protein_db_file_, peptide_input_file_, protein_output_file_;
+  std::string digest_cache_key_;
   
-  void addToPeptideProteinMap(PercolatorCrux::Database& db, 
-    size_t protein_idx, PercolatorCrux::PeptideConstraint& peptide_constraint,
-    std::map<std::string, std::vector<size_t> >& peptide_protein_map,
+  bool getDigestCacheKey(std::string& key);
+  
+  void digestProteins(PercolatorCrux::Database& db, 
+    const std::vector<size_t>& protein_idxs,
+    PercolatorCrux::PeptideConstraint& peptide_constraint,
+    PeptideProteinIndex& peptide_protein_index,
     std::map<size_t, size_t>& num_peptides_per_protein,
     bool reverseProteinSeqs);
+  size_t digestProtein(PercolatorCrux::Protein* protein, size_t protein_idx,
+    PercolatorCrux::PeptideConstraint& peptide_constraint,
+    std::vector<PeptideProteinIndex::Entry>& peptides);
   
   void findFragmentProteins(PercolatorCrux::Database& db, 
-    size_t protein_idx, PercolatorCrux::PeptideConstraint& peptide_constraint,
-    std::map<std::string, std::vector<size_t> >& peptide_protein_map,
+    const std::vector<size_t>& protein_idxs,
+    PercolatorCrux::PeptideConstraint& peptide_constraint,
+    const PeptideProteinIndex& peptide_protein_index,
     std::map<size_t, size_t>& num_peptides_per_protein,
     std::map<size_t, std::vector<size_t> >& fragment_protein_map);
+  bool findSupersetProteins(PercolatorCrux::Database& db, 
+    size_t protein_idx, PercolatorCrux::PeptideConstraint& peptide_constraint,
+    const PeptideProteinIndex& peptide_protein_index,
+    std::vector<size_t>& protein_idx_intersection);
   void addToFragmentProteinMap(
     const size_t protein_idx, std::vector<size_t>& protein_idx_intersection,
     std::map<size_t, size_t>& num_peptides_per_protein,
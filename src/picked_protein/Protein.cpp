@@ -377,6 +377,71 @@ bool Protein::parseProteinFastaFile(
 
 }
 
+/**
+ * Table of the conversions of readRawSequence: the upper case letter that
+ * each character is stored as, or '\0' if it is skipped.
+ */
+struct SequenceCharTable {
+  char converted[256];
+  SequenceCharTable() {
+    for (int a_char = 0; a_char < 256; ++a_char) {
+      converted[a_char] = '\0';
+      if (isalpha(a_char)) {
+        int upper = toupper(a_char);
+        converted[a_char] = (upper < 'A' || upper > 'Z') ? 'X' : (char)upper;
+      }
+    }
+  }
+};
+static const SequenceCharTable sequence_char_table;
+
+/**
+ * Parses a protein in place from a record of a memory mapped (FASTA) file.
+ * The record starts with '>' and the byte at its end must be writable, it
+ * may receive the null character that terminates the sequence. Applies the
+ * same rules as readTitleLine and readRawSequence.
+ * \returns TRUE if success. FALSE is failure.
+ */
+bool Protein::parseProteinFastaMemmap(
+  char* record, ///< start of the record in the mapped file -in/out
+  char* record_end ///< end of the record -in
+  )
+{
+  char* line_end = (char*)memchr(record, '\n', record_end - record);
+  if (line_end == NULL) {
+    line_end = record_end;
+  }
+
+  // the id is the first word of the title line
+  char* id = record + 1;
+  while (id < line_end && isspace((unsigned char)*id)) {
+    ++id;
+  }
+  char* id_end = id;
+  while (id_end < line_end && !isspace((unsigned char)*id_end)) {
+    ++id_end;
+  }
+  *id_end = '\0';
+  id_ = id;
+
+  // keep the letters of the sequence lines, converting them as in
+  // readRawSequence
+  char* sequence = (std::min)(line_end + 1, record_end);
+  char* write = sequence;
+  for (char* read = sequence; read < record_end; ++read) {
+    char a_char = sequence_char_table.converted[(unsigned char)*read];
+    if (a_char != '\0') {
+      *write++ = a_char;
+    }
+  }
+  *write = '\0';
+  sequence_ = sequence;
+  length_ = write - sequence;
+
+  is_memmap_ = true;
+  return(true);
+}
+
 /**************************************************/
 
 /**
@@ -592,10 +657,15 @@ void Protein::setId(
   const char* id ///< the sequence to add -in
   )
 {
-  free(id_);
   int id_length = strlen(id) +1; // +\0
-  char* copy_id = 
-    (char *)malloc(sizeof(char)*id_length);
+  char* copy_id;
+  if (is_memmap_) {
+    // the id points into the database's memory, which also keeps the new one
+    copy_id = database_->allocate(id_length);
+  } else {
+    free(id_);
+    copy_id = (char *)malloc(sizeof(char)*id_length);
+  }
   id_ =
     strncpy(copy_id, id, id_length);  
 }
@@ -170,6 +170,18 @@ class Protein {
     ///< a pointer to a pointer to the memory mapped binary fasta file -in
   );
 
+  /**
+   * Parses a protein in place from a record of a memory mapped (FASTA)
+   * file, which starts with '>' and is followed by a writable byte. The id
+   * is terminated in the title line and the sequence is compacted over its
+   * line breaks, such that both point into the record.
+   * \returns TRUE if success. FALSE is failure.
+   */
+  bool parseProteinFastaMemmap(
+    char* record, ///< start of the record in the mapped file -in/out
+    char* record_end ///< end of the record -in
+  );
+
   /**
    * Change the sequence of a protein to be a randomized version of
    * itself.  The method of randomization is dependant on the
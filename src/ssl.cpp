@@ -22,19 +22,198 @@ using namespace std;
 // for compatibility issues, not using log2
 
 AlgIn::AlgIn(const int size, const int numFeat) {
-  vals = new const double*[size];
+  vals = new const FeatureValue*[size];
   Y = new double[size];
   C = new double[size];
   n = numFeat;
   positives = 0;
   negatives = 0;
+  sparse = NULL;
+  zeros = NULL;
+  sparseFormat_ = FORMAT_UNDECIDED;
 }
 AlgIn::~AlgIn() {
+  clearSparse();
+  delete[] zeros;
   delete[] vals;
   delete[] Y;
   delete[] C;
 }
 
+/* Stores the examples in CRS format, leaving out the entries equal to 
+   featureZeros (e.g. the normalized zeros of one-hot features), if this 
+   leaves less than SPARSE_DENSITY of the entries. The format is chosen on
+   the first call and the compressed rows are kept, so that later calls only
+   compress the examples that earlier training sets did not contain. Returns
+   true if the sparse examples will be used by CGLS and L2_SVM_MFN. */
+bool AlgIn::buildSparse(const std::vector<double>& featureZeros) {
+  clearSparse();
+  const int numFeatures = n - 1;
+  if (m <= 0 || numFeatures <= 0 || 
+      featureZeros.size() < static_cast<size_t>(numFeatures)) {
+    return false;
+  }
+  if (!hasZeros(featureZeros)) {
+    resetRowCache(featureZeros);
+  }
+  if (sparseFormat_ == FORMAT_UNDECIDED) {
+    double nz = 0.0;
+    for (int i = 0; i < m; i++) {
+      nz += countEntries(vals[i]);
+    }
+    sparseFormat_ = (nz < SPARSE_DENSITY * m * numFeatures) ? 
+                    FORMAT_SPARSE : FORMAT_DENSE;
+  }
+  if (sparseFormat_ == FORMAT_DENSE) {
+    return false;
+  }
+  
+  std::vector<int> rows(m);
+  std::vector<std::pair<const FeatureValue*, int> > newRows;
+  int nz = 0;
+  for (int i = 0; i < m; i++) {
+    int row = findRow(vals[i]);
+    if (row < 0) {
+      row = compressRow(vals[i]);
+      newRows.push_back(std::make_pair(vals[i], row));
+    }
+    rows[i] = row;
+    nz += rowStart_[row + 1] - rowStart_[row];
+  }
+  if (!newRows.empty()) {
+    std::sort(newRows.begin(), newRows.end());
+    size_t numIndexed = rowIndex_.size();
+    rowIndex_.insert(rowIndex_.end(), newRows.begin(), newRows.end());
+    std::inplace_merge(rowIndex_.begin(), rowIndex_.begin() + numIndexed,
+                       rowIndex_.end());
+  }
+  
+  sparse = new struct data;
+  sparse->m = m;
+  sparse->l = m;
+  sparse->u = 0;
+  sparse->n = n;
+  sparse->nz = nz;
+  sparse->val = new double[nz];
+  sparse->colind = new int[nz];
+  sparse->rowptr = new int[m + 1];
+  sparse->Y = Y;
+  sparse->C = C;
+  int k = 0;
+  for (int i = 0; i < m; i++) {
+    sparse->rowptr[i] = k;
+    for (int c = rowStart_[rows[i]]; c < rowStart_[rows[i] + 1]; c++) {
+      sparse->val[k] = rowVal_[c];
+      sparse->colind[k++] = rowColind_[c];
+    }
+  }
+  sparse->rowptr[m] = k;
+  if (VERB > 3) {
+    cerr << "Using sparse SVM input with " << nz / ((double)m * numFeatures)
+         << " of the feature values stored" << endl;
+  }
+  return true;
+}
+
+void AlgIn::clearSparse() {
+  if (sparse) {
+    delete[] sparse->val;
+    delete[] sparse->colind;
+    delete[] sparse->rowptr;
+    delete sparse;
+    sparse = NULL;
+  }
+}
+
+/* forgets the format and the compressed rows, and sets the zeros */
+void AlgIn::resetRowCache(const std::vector<double>& featureZeros) {
+  const int numFeatures = n - 1;
+  sparseFormat_ = FORMAT_UNDECIDED;
+  rowIndex_.clear();
+  rowStart_.assign(1, 0);
+  rowVal_.clear();
+  rowColind_.clear();
+  // compare in storage precision, so that zero entries cancel exactly
+  implicitZeros_.resize(numFeatures);
+  delete[] zeros;
+  zeros = new double[numFeatures];
+  for (int j = 0; j < numFeatures; j++) {
+    implicitZeros_[j] = static_cast<FeatureValue>(featureZeros[j]);
+    zeros[j] = implicitZeros_[j];
+  }
+}
+
+bool AlgIn::hasZeros(const std::vector<double>& featureZeros) const {
+  if (zeros == NULL) return false;
+  for (int j = 0; j < n - 1; j++) {
+    if (implicitZeros_[j] != static_cast<FeatureValue>(featureZeros[j])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int AlgIn::countEntries(const FeatureValue* val) const {
+  int count = 0;
+  for (int j = 0; j < n - 1; j++) {
+    if (val[j] != implicitZeros_[j]) count++;
+  }
+  return count;
+}
+
+/* index of the compressed copy of val, or -1 if it has not been stored */
+int AlgIn::findRow(const FeatureValue* val) const {
+  std::vector<std::pair<const FeatureValue*, int> >::const_iterator it = 
+      std::lower_bound(rowIndex_.begin(), rowIndex_.end(), 
+                       std::make_pair(val, -1));
+  if (it != rowIndex_.end() && it->first == val) return it->second;
+  return -1;
+}
+
+int AlgIn::compressRow(const FeatureValue* val) {
+  for (int j = 0; j < n - 1; j++) {
+    if (val[j] != implicitZeros_[j]) {
+      rowVal_.push_back(val[j] - zeros[j]);
+      rowColind_.push_back(j);
+    }
+  }
+  rowStart_.push_back(static_cast<int>(rowVal_.size()));
+  return static_cast<int>(rowStart_.size()) - 2;
+}
+
+/* sum of zeros[j] * w[j], the part of x.w that all sparse examples share */
+static double zerosDot(const AlgIn& data, const double* w) {
+  double t = 0.0;
+  for (int j = 0; j < data.n - 1; j++) {
+    t += data.zeros[j] * w[j];
+  }
+  return t;
+}
+
+/* x.w over the stored entries of sparse example i */
+static inline double sparseDot(const struct data* sp, int i, const double* w) {
+  double t = 0.0;
+  for (int k = sp->rowptr[i]; k < sp->rowptr[i + 1]; k++) {
+    t += sp->val[k] * w[sp->colind[k]];
+  }
+  return t;
+}
+
+/* r += z * x over the stored entries of sparse example i */
+static inline void sparseAdd(const struct data* sp, int i, double z, double* r) {
+  for (int k = sp->rowptr[i]; k < sp->rowptr[i + 1]; k++) {
+    r[sp->colind[k]] += sp->val[k] * z;
+  }
+}
+
+/* r += zSum * (zeros, 1), the part of X'z that all sparse examples share */
+static void addZeros(const AlgIn& data, double zSum, double* r) {
+  for (int j = 0; j < data.n - 1; j++) {
+    r[j] += data.zeros[j] * zSum;
+  }
+  r[data.n - 1] += zSum;
+}
+
 int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
          const double epsilon, const struct vector_int* Subset,
          struct vector_double* Weights, struct vector_double* Outputs) {
@@ -46,7 +225,7 @@ int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
   tictoc.restart();
   int active = Subset->d;
   int* J = Subset->vec;
-  const double** set = data.vals;
+  const FeatureValue** set = data.vals;
   const double* Y = data.Y;
   const double* C = data.C;
   const int n = data.n;
@@ -57,7 +236,7 @@ int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
   double* z = new double[active];
   double* q = new double[active];
   int ii = 0;
-  register int i, j;
+  int i, j;
   for (i = active; i--;) {
     ii = J[i];
     z[i] = C[ii] * (Y[ii] - o[ii]);
@@ -66,12 +245,21 @@ int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
   for (i = n; i--;) {
     r[i] = 0.0;
   }
-  for (j = 0; j < active; j++) {
-    const double* val = set[J[j]];
-    for (i = n - 1; i--;) {
-      r[i] += val[i] * z[j];
+  if (data.sparse) {
+    double zSum = 0.0;
+    for (j = 0; j < active; j++) {
+      sparseAdd(data.sparse, J[j], z[j], r);
+      zSum += z[j];
+    }
+    addZeros(data, zSum, r);
+  } else {
+    for (j = 0; j < active; j++) {
+      const FeatureValue* val = set[J[j]];
+      for (i = n - 1; i--;) {
+        r[i] += val[i] * z[j];
+      }
+      r[n - 1] += z[j];
     }
-    r[n - 1] += z[j];
   }
   double* p = new double[n];
   double omega1 = 0.0;
@@ -96,16 +284,27 @@ int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
     double t = 0.0;
     //    register int i,j;
     // #pragma omp parallel for private(i,j)
-    for (i = 0; i < active; i++) {
-      ii = J[i];
-      t = 0.0;
-      const double* val = set[ii];
-      for (j = 0; j < n - 1; j++) {
-        t += val[j] * p[j];
+    if (data.sparse) {
+      double pZeros = zerosDot(data, p);
+      for (i = 0; i < active; i++) {
+        ii = J[i];
+        t = pZeros + sparseDot(data.sparse, ii, p);
+        t += p[n - 1];
+        q[i] = t;
+        omega_q += C[ii] * t * t;
+      }
+    } else {
+      for (i = 0; i < active; i++) {
+        ii = J[i];
+        t = 0.0;
+        const FeatureValue* val = set[ii];
+        for (j = 0; j < n - 1; j++) {
+          t += val[j] * p[j];
+        }
+        t += p[n - 1];
+        q[i] = t;
+        omega_q += C[ii] * t * t;
       }
-      t += p[n - 1];
-      q[i] = t;
-      omega_q += C[ii] * t * t;
     }
     gamma = omega1 / (lambda * omega_p + omega_q);
     inv_omega2 = 1 / omega1;
@@ -120,14 +319,23 @@ int CGLS(const AlgIn& data, const double lambda, const int cgitermax,
       z[i] -= gamma * C[ii] * q[i];
       omega_z += z[i] * z[i];
     }
-    for (register int j = 0; j < active; j++) {
-      ii = J[j];
-      t = z[j];
-      const double* val = set[ii];
-      for (register int i = 0; i < n - 1; i++) {
-        r[i] += val[i] * t;
+    if (data.sparse) {
+      double zSum = 0.0;
+      for (int j = 0; j < active; j++) {
+        sparseAdd(data.sparse, J[j], z[j], r);
+        zSum += z[j];
+      }
+      addZeros(data, zSum, r);
+    } else {
+      for (int j = 0; j < active; j++) {
+        ii = J[j];
+        t = z[j];
+        const FeatureValue* val = set[ii];
+        for (int i = 0; i < n - 1; i++) {
+          r[i] += val[i] * t;
+        }
+        r[n - 1] += t;
       }
-      r[n - 1] += t;
     }
     omega1 = 0.0;
     for (int i = n; i--;) {
@@ -169,7 +377,7 @@ int L2_SVM_MFN(const AlgIn& data, struct options* Options,
   /* Disassemble the structures */
   timer tictoc;
   tictoc.restart();
-  const double** set = data.vals;
+  const FeatureValue** set = data.vals;
   const double* Y = data.Y;
   const double* C = data.C;
   const int n = Weights->d;
@@ -239,14 +447,22 @@ int L2_SVM_MFN(const AlgIn& data, struct options* Options,
                ActiveSubset,
                Weights_bar,
                Outputs_bar);
-    for (register int i = active; i < m; i++) {
-      ii = ActiveSubset->vec[i];
-      const double* val = set[ii];
-      t = w_bar[n - 1];
-      for (register int j = n - 1; j--;) {
-        t += val[j] * w_bar[j];
+    if (data.sparse) {
+      double wZeros = zerosDot(data, w_bar);
+      for (int i = active; i < m; i++) {
+        ii = ActiveSubset->vec[i];
+        o_bar[ii] = w_bar[n - 1] + wZeros + sparseDot(data.sparse, ii, w_bar);
+      }
+    } else {
+      for (int i = active; i < m; i++) {
+        ii = ActiveSubset->vec[i];
+        const FeatureValue* val = set[ii];
+        t = w_bar[n - 1];
+        for (int j = n - 1; j--;) {
+          t += val[j] * w_bar[j];
+        }
+        o_bar[ii] = t;
       }
-      o_bar[ii] = t;
     }
     if (ini == 0) {
       cgitermax = CGITERMAX;
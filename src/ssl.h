@@ -7,8 +7,11 @@
 #ifndef _svmlin_H
 #define _svmlin_H
 #include <vector>
+#include <utility>
 #include <ctime>
 
+#include "FeatureMemoryPool.h"
+
 using namespace std;
 
 /* OPTIMIZATION CONSTANTS */
@@ -20,6 +23,7 @@ using namespace std;
 #define MFNITERMAX 50 /* maximum number of MFN iterations */
 
 #define VERBOSE_CGLS 0
+#define SPARSE_DENSITY 0.3 /* max. fraction of stored entries for sparse input */
 
 class AlgIn {
   public:
@@ -29,9 +33,15 @@ class AlgIn {
     int n; /* number of features */
     int positives;
     int negatives;
-    const double** vals;
+    const FeatureValue** vals;
     double* Y; /* labels */
     double* C; /* cost associated with each example */
+    /* sparse copy of vals, only set if few feature values differ from zeros.
+       Entry (i,j) holds vals[i][j] - zeros[j]; left out entries are 0 */
+    struct data* sparse;
+    double* zeros; /* implicit value of each feature, n-1 elements */
+    bool buildSparse(const std::vector<double>& featureZeros);
+    void clearSparse();
     void setCost(double pos, double neg) {
       int ix = 0;
       for (; ix < negatives; ++ix) {
@@ -41,6 +51,23 @@ class AlgIn {
         C[ix] = pos;
       }
     }
+  private:
+    enum SparseFormat { FORMAT_UNDECIDED, FORMAT_DENSE, FORMAT_SPARSE };
+    /* the format is chosen on the first call of buildSparse, after which the
+       compressed rows are kept, as consecutive training sets share most of 
+       their examples */
+    SparseFormat sparseFormat_;
+    std::vector<FeatureValue> implicitZeros_; /* zeros in storage precision */
+    /* compressed rows sorted on the address of their dense row */
+    std::vector<std::pair<const FeatureValue*, int> > rowIndex_;
+    std::vector<int> rowStart_; /* rowStart_[r] to rowStart_[r+1] for row r */
+    std::vector<double> rowVal_;
+    std::vector<int> rowColind_;
+    void resetRowCache(const std::vector<double>& featureZeros);
+    bool hasZeros(const std::vector<double>& featureZeros) const;
+    int countEntries(const FeatureValue* val) const;
+    int findRow(const FeatureValue* val) const;
+    int compressRow(const FeatureValue* val);
 };
 
 /* Data: Input examples are stored in sparse (Compressed Row Storage) format */
@@ -51,7 +78,7 @@ struct data {
     int n; /* number of features */
     int nz; /* number of non-zeros */
     double* val; /* data values (nz elements) [CRS format] */
-    int* rowptr; /* n+1 vector [CRS format] */
+    int* rowptr; /* m+1 vector [CRS format] */
     int* colind; /* nz elements [CRS format] */
     double* Y; /* labels */
     double* C; /* cost associated with each example */
@@ -2415,6 +2415,83 @@ double svm_predict(const svm_model* model, const svm_node* x) {
   }
 }
 
+// Block size of svm_predict_batch: the squared distances of this many
+// instances to a support vector are accumulated side by side, so that each
+// support vector is read once per block and the inner loop vectorizes
+static const int kPredictBlock = 16;
+
+#ifdef _DENSE_REP
+// Evaluates the RBF regression function for instances x[0], ..., x[n-1]
+// that all have dimension dim. Every distance and kernel sum is accumulated
+// in the same order as in svm_predict_values, so the results are identical.
+static void rbf_regression_block(const svm_model* model, const svm_node* x,
+                                 int n, int dim, double* dec_values) {
+  const double* sv_coef = model->sv_coef[0];
+  const double gamma = model->param.gamma;
+  double sum[kPredictBlock], dist[kPredictBlock];
+  for (int p = 0; p < n; p++) {
+    sum[p] = 0;
+  }
+  for (int i = 0; i < model->l; i++) {
+    const svm_node& sv = model->SV[i];
+    const double* y = sv.values;
+    int common = min(dim, sv.dim), j;
+    for (int p = 0; p < n; p++) {
+      dist[p] = 0;
+    }
+    for (j = 0; j < common; j++) {
+      const double yj = y[j];
+      for (int p = 0; p < n; p++) {
+        double d = x[p].values[j] - yj;
+        dist[p] += d * d;
+      }
+    }
+    for (; j < dim; j++) {
+      for (int p = 0; p < n; p++) {
+        dist[p] += x[p].values[j] * x[p].values[j];
+      }
+    }
+    for (; j < sv.dim; j++) {
+      for (int p = 0; p < n; p++) {
+        dist[p] += y[j] * y[j];
+      }
+    }
+    for (int p = 0; p < n; p++) {
+      sum[p] += sv_coef[i] * exp(-gamma * dist[p]);
+    }
+  }
+  for (int p = 0; p < n; p++) {
+    dec_values[p] = sum[p] - model->rho[0];
+  }
+}
+#endif
+
+void svm_predict_batch(const svm_model* model, const svm_node* x, int n,
+                       double* predictions) {
+  const int numBlocks = (n + kPredictBlock - 1) / kPredictBlock;
+#pragma omp parallel for schedule(dynamic, 1) if(numBlocks > 1)
+  for (int block = 0; block < numBlocks; block++) {
+    int first = block * kPredictBlock;
+    int last = min(n, first + kPredictBlock);
+#ifdef _DENSE_REP
+    bool sameDim = true;
+    for (int p = first + 1; p < last; p++) {
+      sameDim = sameDim && (x[p].dim == x[first].dim);
+    }
+    if (sameDim && model->param.kernel_type == RBF &&
+        (model->param.svm_type == EPSILON_SVR || 
+         model->param.svm_type == NU_SVR)) {
+      rbf_regression_block(model, x + first, last - first, x[first].dim, 
+                           predictions + first);
+      continue;
+    }
+#endif
+    for (int p = first; p < last; p++) {
+      predictions[p] = svm_predict(model, x + p);
+    }
+  }
+}
+
 double svm_predict_probability(const svm_model* model, const svm_node* x,
                                double* prob_estimates) {
   if ((model->param.svm_type == C_SVC || model->param.svm_type == NU_SVC)
@@ -107,6 +107,10 @@ void svm_predict_values(const struct svm_model* model,
                         const struct svm_node* x, double* dec_values);
 double
 svm_predict(const struct svm_model* model, const struct svm_node* x);
+/* predicts the n instances x[0], ..., x[n-1] into predictions, giving the
+   same values as svm_predict on each instance */
+void svm_predict_batch(const struct svm_model* model, const struct svm_node* x,
+                       int n, double* predictions);
 double svm_predict_probability(const struct svm_model* model,
                                const struct svm_node* x,
                                double* prob_estimates);